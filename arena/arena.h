@@ -0,0 +1,182 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Monotonic arena: allocations bump a pointer through blocks of geometrically growing size and
+// are never freed one by one; `Release` (or the destructor) returns all blocks at once. Meant
+// for short-lived object graphs, e.g. everything built while handling one request.
+//
+// `ArenaScope` makes an arena current for the calling thread, for `MakeArenaShared` and
+// `MakeArenaUnique`; anything created this way must not outlive the arena. Nothing else moves
+// into the arena on its own: `MakeShared` keeps using the heap, and containers opt in
+// explicitly through `ArenaAllocator`, e.g. `COWVector<T, ArenaAllocator<T>>`. An arena is used
+// by one thread at a time.
+class MonotonicArena {
+private:
+    struct Block {
+        Block* next;
+    };
+
+    // Objects from `Create` whose destructors still have to run on `Release`
+    struct Finalizer {
+        void (*destroy)(void* object);
+        void* object;
+        Finalizer* next;
+    };
+
+    static constexpr size_t kHeaderSize =
+        (sizeof(Block) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) *
+        alignof(std::max_align_t);
+    static constexpr size_t kMaxBlockSize = size_t(1) << 20;
+
+    Block* blocks_ = nullptr;
+    unsigned char* cursor_ = nullptr;
+    unsigned char* limit_ = nullptr;
+    size_t next_block_size_;
+    size_t initial_block_size_;
+    Finalizer* finalizers_ = nullptr;
+
+    static MonotonicArena*& CurrentSlot() {
+        static thread_local MonotonicArena* current = nullptr;
+        return current;
+    }
+
+    void* AllocateSlow(size_t size, size_t alignment) {
+        size_t block_size = std::max(next_block_size_, kHeaderSize + size + alignment);
+        next_block_size_ = std::min(next_block_size_ * 2, std::max(kMaxBlockSize, block_size));
+        auto* block = static_cast<Block*>(::operator new(block_size));
+        block->next = blocks_;
+        blocks_ = block;
+        cursor_ = reinterpret_cast<unsigned char*>(block) + kHeaderSize;
+        limit_ = reinterpret_cast<unsigned char*>(block) + block_size;
+        return Allocate(size, alignment);
+    }
+
+    friend class ArenaScope;
+
+public:
+    explicit MonotonicArena(size_t initial_block_size = 4096)
+        : next_block_size_(std::max(initial_block_size, kHeaderSize)),
+          initial_block_size_(next_block_size_) {
+    }
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    ~MonotonicArena() {
+        Release();
+    }
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+        auto address = reinterpret_cast<uintptr_t>(cursor_);
+        size_t padding = (alignment - address % alignment) % alignment;
+        if (static_cast<size_t>(limit_ - cursor_) < padding + size) {
+            return AllocateSlow(size, alignment);
+        }
+        void* result = cursor_ + padding;
+        cursor_ += padding + size;
+        return result;
+    }
+
+    // Constructs an object owned by the arena. Its destructor runs on `Release`, unless it is
+    // trivial, in which case nothing is recorded at all
+    template <typename T, typename... Args>
+    T* Create(Args&&... args) {
+        T* object = ::new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            auto* finalizer = ::new (Allocate(sizeof(Finalizer), alignof(Finalizer)))
+                Finalizer{[](void* pointer) { static_cast<T*>(pointer)->~T(); }, object,
+                          finalizers_};
+            finalizers_ = finalizer;
+        }
+        return object;
+    }
+
+    // Runs the destructors of `Create`d objects, newest first, and frees every block
+    void Release() {
+        for (Finalizer* finalizer = finalizers_; finalizer != nullptr;
+             finalizer = finalizer->next) {
+            finalizer->destroy(finalizer->object);
+        }
+        finalizers_ = nullptr;
+        while (blocks_ != nullptr) {
+            ::operator delete(std::exchange(blocks_, blocks_->next));
+        }
+        cursor_ = limit_ = nullptr;
+        next_block_size_ = initial_block_size_;
+    }
+
+    // Arena of the innermost active `ArenaScope` on this thread, or null
+    static MonotonicArena* Current() {
+        return CurrentSlot();
+    }
+};
+
+class ArenaScope {
+private:
+    MonotonicArena* previous_;
+
+public:
+    explicit ArenaScope(MonotonicArena& arena) : previous_(MonotonicArena::CurrentSlot()) {
+        MonotonicArena::CurrentSlot() = &arena;
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    ~ArenaScope() {
+        MonotonicArena::CurrentSlot() = previous_;
+    }
+};
+
+// Standard allocator on top of an arena; `deallocate` is a no-op
+template <typename T>
+class ArenaAllocator {
+private:
+    MonotonicArena* arena_;
+
+    template <typename U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MonotonicArena& arena) : arena_(&arena) {
+    }
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena_) {
+    }
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T*, size_t) {
+    }
+
+    MonotonicArena& Arena() const {
+        return *arena_;
+    }
+
+    template <typename U>
+    friend bool operator==(const ArenaAllocator& left, const ArenaAllocator<U>& right) {
+        return left.arena_ == &right.Arena();
+    }
+};
+
+// Deleter for `UniquePtr` to objects placed in an arena: runs the destructor unless it is
+// trivial and leaves the memory to the arena
+template <typename T>
+struct ArenaDeleter {
+    void operator()(T* ptr) const {
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            ptr->~T();
+        }
+    }
+};
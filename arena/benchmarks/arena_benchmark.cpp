@@ -0,0 +1,38 @@
+#include <arena.h>
+#include <benchmark.h>
+
+#include <new>
+
+namespace {
+
+constexpr size_t kObjects = 256;
+
+struct Small {
+    int64_t values[3];
+};
+
+}  // namespace
+
+// `kObjects` allocations, then all of them freed; the time is per object
+BENCHMARK(ArenaAllocateRelease) {
+    MonotonicArena arena;
+    for (size_t done = 0; done < iterations; done += kObjects) {
+        for (size_t i = 0; i < kObjects; ++i) {
+            DoNotOptimize(arena.Create<Small>());
+        }
+        arena.Release();
+    }
+}
+
+BENCHMARK(NewDelete) {
+    Small* objects[kObjects];
+    for (size_t done = 0; done < iterations; done += kObjects) {
+        for (size_t i = 0; i < kObjects; ++i) {
+            objects[i] = new Small();
+            DoNotOptimize(objects[i]);
+        }
+        for (size_t i = 0; i < kObjects; ++i) {
+            delete objects[i];
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#include <arena.h>
+#include <benchmark.h>
+#include <cow_vector.h>
+#include <shared.h>
+
+#include <memory>
+
+namespace {
+
+constexpr size_t kNodes = 32;
+constexpr size_t kElements = 4 * COWVector<int>::kChunkSize;
+
+struct RequestNode {
+    SharedPtr<RequestNode> next;
+    int64_t value;
+};
+
+// What one request builds and drops: a linked graph of shared pointers, and a vector that is
+// snapshotted and then written, so its state and one chunk are copied. Everything is allocated
+// with `alloc`.
+template <typename Alloc>
+int64_t HandleRequest(const Alloc& alloc) {
+    SharedPtr<RequestNode> head;
+    for (size_t i = 0; i < kNodes; ++i) {
+        head = AllocateShared<RequestNode>(alloc, RequestNode{head, static_cast<int64_t>(i)});
+    }
+    COWVector<int, Alloc> vector(alloc);
+    vector.Reserve(kElements);
+    for (size_t i = 0; i < kElements; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    COWVector<int, Alloc> snapshot = vector;
+    vector.Set(0, -1);
+    return head->value + vector.Get(0) + snapshot.Get(0);
+}
+
+}  // namespace
+
+// Every request in the same arena, released after it; the time is per request
+BENCHMARK(RequestArena) {
+    MonotonicArena arena;
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(HandleRequest(ArenaAllocator<int>(arena)));
+        arena.Release();
+    }
+}
+
+BENCHMARK(RequestNewDelete) {
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(HandleRequest(std::allocator<int>()));
+    }
+}
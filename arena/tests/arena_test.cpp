@@ -0,0 +1,71 @@
+#include <arena.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+TEST(MonotonicArena, AllocationsAreAlignedAndDisjoint) {
+    MonotonicArena arena(64);
+    std::vector<std::pair<unsigned char*, size_t>> blocks;
+    for (size_t size = 1; size < 300; size += 7) {
+        size_t alignment = size % 2 == 0 ? 16 : 8;
+        auto* memory = static_cast<unsigned char*>(arena.Allocate(size, alignment));
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(memory) % alignment, 0u);
+        std::memset(memory, static_cast<int>(size), size);
+        blocks.emplace_back(memory, size);
+    }
+    for (auto [memory, size] : blocks) {
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(memory[i], static_cast<unsigned char>(size));
+        }
+    }
+}
+
+TEST(MonotonicArena, ReleaseRunsDestructorsNewestFirst) {
+    std::vector<int> order;
+    struct Tracked {
+        std::vector<int>* order;
+        int id;
+        ~Tracked() {
+            order->push_back(id);
+        }
+    };
+    MonotonicArena arena;
+    arena.Create<Tracked>(&order, 1);
+    arena.Create<Tracked>(&order, 2);
+    arena.Create<int>(3);
+    EXPECT_TRUE(order.empty());
+    arena.Release();
+    EXPECT_EQ(order, (std::vector<int>{2, 1}));
+    // Usable again after a release
+    EXPECT_EQ(*arena.Create<std::string>("again"), "again");
+}
+
+TEST(ArenaScope, NestsAndRestores) {
+    EXPECT_EQ(MonotonicArena::Current(), nullptr);
+    MonotonicArena outer;
+    MonotonicArena inner;
+    {
+        ArenaScope outer_scope(outer);
+        EXPECT_EQ(MonotonicArena::Current(), &outer);
+        {
+            ArenaScope inner_scope(inner);
+            EXPECT_EQ(MonotonicArena::Current(), &inner);
+        }
+        EXPECT_EQ(MonotonicArena::Current(), &outer);
+    }
+    EXPECT_EQ(MonotonicArena::Current(), nullptr);
+}
+
+TEST(ArenaAllocator, BacksStandardContainers) {
+    MonotonicArena arena;
+    std::vector<int, ArenaAllocator<int>> values{ArenaAllocator<int>(arena)};
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[999], 999);
+    EXPECT_TRUE(ArenaAllocator<int>(arena) == ArenaAllocator<double>(arena));
+}
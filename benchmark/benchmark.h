@@ -0,0 +1,445 @@
+#pragma once
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Micro-benchmark harness without dependencies. A benchmark is a function that runs its
+// operation `iterations` times:
+//
+//     BENCHMARK(MutexLockUnlock) {
+//         Mutex mutex;
+//         for (size_t i = 0; i < iterations; ++i) {
+//             mutex.Lock();
+//             mutex.Unlock();
+//         }
+//     }
+//
+// The iteration count is calibrated so that one repetition takes at least `--min-time-ms`;
+// then `--warmup` repetitions are thrown away and `--repetitions` are measured. Every
+// repetition yields nanoseconds and cycles per operation, reported as percentiles over the
+// repetitions, as a table or, with `--json`, as JSON. Link `benchmark_main.cpp` for `main`.
+// A benchmark may also report metrics of its own through `SetBenchmarkCounter`.
+
+// Keeps the compiler from dropping the computation of `value`
+template <class T>
+inline void DoNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Forces pending stores to memory to be done by this point
+inline void ClobberMemory() {
+    asm volatile("" : : : "memory");
+}
+
+// CPU cycles from a perf_event counter of user-space cycles of this process, including the
+// threads it starts afterwards. Where perf_event is not available (containers, a strict
+// perf_event_paranoid) it falls back to `rdtsc`, which counts reference cycles at a constant
+// rate rather than core cycles, and elsewhere to nothing.
+class CycleCounter {
+public:
+    CycleCounter() {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CPU_CYCLES;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.inherit = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+
+    CycleCounter(const CycleCounter&) = delete;
+    CycleCounter& operator=(const CycleCounter&) = delete;
+
+    ~CycleCounter() {
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+    }
+
+    bool Available() const {
+        return fd_ >= 0 || kHasTimestampCounter;
+    }
+
+    const char* Source() const {
+        if (fd_ >= 0) {
+            return "perf_event";
+        }
+        return kHasTimestampCounter ? "rdtsc" : "none";
+    }
+
+    uint64_t Read() const {
+        if (fd_ >= 0) {
+            uint64_t value = 0;
+            if (read(fd_, &value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))) {
+                return value;
+            }
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+private:
+#if defined(__x86_64__) || defined(__i386__)
+    static constexpr bool kHasTimestampCounter = true;
+#else
+    static constexpr bool kHasTimestampCounter = false;
+#endif
+
+    int fd_;
+};
+
+struct BenchmarkOptions {
+    std::string filter;
+    size_t warmup = 2;
+    size_t repetitions = 10;
+    double min_time_ms = 10;
+    // Fixed iteration count instead of calibration, 0 to calibrate
+    size_t iterations = 0;
+    bool json = false;
+    std::string json_path;
+    bool list = false;
+};
+
+// Percentiles of one metric over the measured repetitions
+struct BenchmarkStats {
+    double min = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+    double mean = 0;
+
+    static BenchmarkStats Of(std::vector<double> samples) {
+        BenchmarkStats stats;
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        // Nearest rank
+        auto at = [&samples](double percentile) {
+            size_t rank = static_cast<size_t>(percentile / 100 * samples.size() + 0.5);
+            return samples[std::min(samples.size() - 1, rank > 0 ? rank - 1 : 0)];
+        };
+        stats.min = samples.front();
+        stats.p50 = at(50);
+        stats.p90 = at(90);
+        stats.p99 = at(99);
+        stats.max = samples.back();
+        double sum = 0;
+        for (double sample : samples) {
+            sum += sample;
+        }
+        stats.mean = sum / samples.size();
+        return stats;
+    }
+};
+
+struct BenchmarkResult {
+    std::string name;
+    size_t iterations;
+    size_t repetitions;
+    BenchmarkStats nanoseconds;
+    BenchmarkStats cycles;
+    std::vector<std::pair<std::string, BenchmarkStats>> counters;
+};
+
+inline std::vector<std::pair<std::string, double>>& BenchmarkCounters() {
+    static std::vector<std::pair<std::string, double>> counters;
+    return counters;
+}
+
+// Reports a metric other than time for the running repetition, e.g. resident memory in KiB.
+// The last value set in a repetition counts; it is reported as percentiles over repetitions.
+inline void SetBenchmarkCounter(std::string_view name, double value) {
+    for (auto& [counter, counter_value] : BenchmarkCounters()) {
+        if (counter == name) {
+            counter_value = value;
+            return;
+        }
+    }
+    BenchmarkCounters().emplace_back(name, value);
+}
+
+using BenchmarkFunction = std::function<void(size_t iterations)>;
+
+struct BenchmarkEntry {
+    std::string name;
+    BenchmarkFunction function;
+};
+
+inline std::vector<BenchmarkEntry>& BenchmarkRegistry() {
+    static std::vector<BenchmarkEntry> registry;
+    return registry;
+}
+
+// Adds a benchmark from a static initializer; returns a value to initialize it with.
+// Parametrized variants are registered under names like "Load/threads:4".
+inline bool RegisterBenchmark(std::string name, BenchmarkFunction function) {
+    BenchmarkRegistry().push_back({std::move(name), std::move(function)});
+    return true;
+}
+
+// The body gets a name of its own, so a benchmark can be named after the function it measures
+#define BENCHMARK(name)                                                                        \
+    static void name##Benchmark(size_t iterations);                                            \
+    [[maybe_unused]] static const bool name##Registered =                                      \
+        RegisterBenchmark(#name, name##Benchmark);                                             \
+    static void name##Benchmark(size_t iterations)
+
+class BenchmarkRunner {
+public:
+    explicit BenchmarkRunner(BenchmarkOptions options) : options_(std::move(options)) {
+    }
+
+    BenchmarkResult Run(const BenchmarkEntry& entry) {
+        size_t iterations = options_.iterations > 0 ? options_.iterations : Calibrate(entry);
+        for (size_t i = 0; i < options_.warmup; ++i) {
+            entry.function(iterations);
+        }
+        std::vector<double> nanoseconds;
+        std::vector<double> cycles;
+        std::vector<std::pair<std::string, std::vector<double>>> counters;
+        for (size_t i = 0; i < options_.repetitions; ++i) {
+            BenchmarkCounters().clear();
+            auto [elapsed, elapsed_cycles] = Measure(entry, iterations);
+            nanoseconds.push_back(elapsed / iterations);
+            cycles.push_back(static_cast<double>(elapsed_cycles) / iterations);
+            for (const auto& [name, value] : BenchmarkCounters()) {
+                auto samples = std::find_if(counters.begin(), counters.end(),
+                                            [&name](const auto& c) { return c.first == name; });
+                if (samples == counters.end()) {
+                    samples = counters.insert(counters.end(), {name, {}});
+                }
+                samples->second.push_back(value);
+            }
+        }
+        BenchmarkResult result{entry.name, iterations, options_.repetitions,
+                               BenchmarkStats::Of(std::move(nanoseconds)),
+                               BenchmarkStats::Of(std::move(cycles)), {}};
+        for (auto& [name, samples] : counters) {
+            result.counters.emplace_back(name, BenchmarkStats::Of(std::move(samples)));
+        }
+        return result;
+    }
+
+    const CycleCounter& Cycles() const {
+        return cycles_;
+    }
+
+private:
+    static constexpr size_t kMaxIterations = size_t(1) << 30;
+
+    BenchmarkOptions options_;
+    CycleCounter cycles_;
+
+    std::pair<double, uint64_t> Measure(const BenchmarkEntry& entry, size_t iterations) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t start_cycles = cycles_.Read();
+        entry.function(iterations);
+        uint64_t end_cycles = cycles_.Read();
+        auto end = std::chrono::steady_clock::now();
+        return {std::chrono::duration<double, std::nano>(end - start).count(),
+                end_cycles - start_cycles};
+    }
+
+    // Grows the iteration count until one run takes `min_time_ms`
+    size_t Calibrate(const BenchmarkEntry& entry) {
+        double target = options_.min_time_ms * 1e6;
+        size_t iterations = 1;
+        while (iterations < kMaxIterations) {
+            double elapsed = Measure(entry, iterations).first;
+            if (elapsed >= target) {
+                break;
+            }
+            // Aim a bit past the target, but at most 10x per step in case of noise
+            double scale = elapsed > 0 ? target * 1.2 / elapsed : 10;
+            iterations = std::min(kMaxIterations,
+                                  std::max(iterations + 1, static_cast<size_t>(
+                                                               iterations * std::min(scale, 10.0))));
+        }
+        return iterations;
+    }
+};
+
+inline void PrintJsonString(FILE* out, std::string_view text) {
+    std::fputc('"', out);
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+    std::fputc('"', out);
+}
+
+inline void PrintJsonStats(FILE* out, const BenchmarkStats& stats) {
+    std::fprintf(out,
+                 "{\"min\": %.3f, \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f, "
+                 "\"mean\": %.3f}",
+                 stats.min, stats.p50, stats.p90, stats.p99, stats.max, stats.mean);
+}
+
+inline void PrintJson(FILE* out, const BenchmarkOptions& options, const CycleCounter& cycles,
+                      const std::vector<BenchmarkResult>& results) {
+    std::fprintf(out, "{\n  \"context\": {\"cycle_source\": \"%s\", \"warmup\": %zu, ",
+                 cycles.Source(), options.warmup);
+    std::fprintf(out, "\"repetitions\": %zu, \"min_time_ms\": %.3f},\n  \"benchmarks\": [",
+                 options.repetitions, options.min_time_ms);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        std::fprintf(out, "%s\n    {\"name\": ", i > 0 ? "," : "");
+        PrintJsonString(out, result.name);
+        std::fprintf(out, ", \"iterations\": %zu, \"repetitions\": %zu,\n     \"ns_per_op\": ",
+                     result.iterations, result.repetitions);
+        PrintJsonStats(out, result.nanoseconds);
+        std::fprintf(out, ",\n     \"cycles_per_op\": ");
+        if (cycles.Available()) {
+            PrintJsonStats(out, result.cycles);
+        } else {
+            std::fprintf(out, "null");
+        }
+        if (!result.counters.empty()) {
+            std::fprintf(out, ",\n     \"counters\": {");
+            for (size_t c = 0; c < result.counters.size(); ++c) {
+                std::fprintf(out, "%s", c > 0 ? ", " : "");
+                PrintJsonString(out, result.counters[c].first);
+                std::fprintf(out, ": ");
+                PrintJsonStats(out, result.counters[c].second);
+            }
+            std::fprintf(out, "}");
+        }
+        std::fprintf(out, "}");
+    }
+    std::fprintf(out, "\n  ]\n}\n");
+}
+
+inline void PrintTableHeader(FILE* out, const CycleCounter& cycles) {
+    std::fprintf(out, "%-44s %12s %12s %12s %12s %14s\n", "benchmark", "iterations", "p50 ns",
+                 "p90 ns", "p99 ns", cycles.Available() ? "p50 cycles" : "");
+}
+
+inline void PrintTableRow(FILE* out, const CycleCounter& cycles, const BenchmarkResult& result) {
+    std::fprintf(out, "%-44s %12zu %12.2f %12.2f %12.2f", result.name.c_str(), result.iterations,
+                 result.nanoseconds.p50, result.nanoseconds.p90, result.nanoseconds.p99);
+    if (cycles.Available()) {
+        std::fprintf(out, " %14.1f", result.cycles.p50);
+    }
+    // Counters follow as `name=p50`
+    for (const auto& [name, stats] : result.counters) {
+        std::fprintf(out, "  %s=%.0f", name.c_str(), stats.p50);
+    }
+    std::fprintf(out, "\n");
+}
+
+// Returns false on an unknown argument
+inline bool ParseBenchmarkOptions(int argc, char** argv, BenchmarkOptions* options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        auto value = [&arg](std::string_view prefix) -> const char* {
+            return arg.substr(0, prefix.size()) == prefix ? arg.data() + prefix.size() : nullptr;
+        };
+        if (const char* filter = value("--filter=")) {
+            options->filter = filter;
+        } else if (const char* warmup = value("--warmup=")) {
+            options->warmup = std::strtoull(warmup, nullptr, 10);
+        } else if (const char* repetitions = value("--repetitions=")) {
+            options->repetitions = std::max<size_t>(1, std::strtoull(repetitions, nullptr, 10));
+        } else if (const char* min_time = value("--min-time-ms=")) {
+            options->min_time_ms = std::strtod(min_time, nullptr);
+        } else if (const char* iterations = value("--iterations=")) {
+            options->iterations = std::strtoull(iterations, nullptr, 10);
+        } else if (const char* path = value("--json=")) {
+            options->json_path = path;
+        } else if (arg == "--json") {
+            options->json = true;
+        } else if (arg == "--list") {
+            options->list = true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs the registered benchmarks whose names contain `--filter`. The table goes to stdout,
+// unless `--json` is given, which prints JSON instead; `--json=<path>` writes it to a file.
+inline int RunBenchmarks(int argc, char** argv) {
+    BenchmarkOptions options;
+    if (!ParseBenchmarkOptions(argc, argv, &options)) {
+        std::fprintf(stderr,
+                     "usage: %s [--filter=<substring>] [--warmup=<n>] [--repetitions=<n>]\n"
+                     "       [--min-time-ms=<ms>] [--iterations=<n>] [--json[=<path>]] [--list]\n",
+                     argv[0]);
+        return 2;
+    }
+    std::vector<BenchmarkEntry> entries;
+    for (const BenchmarkEntry& entry : BenchmarkRegistry()) {
+        if (entry.name.find(options.filter) != std::string::npos) {
+            entries.push_back(entry);
+        }
+    }
+    std::sort(entries.begin(), entries.end(),
+              [](const BenchmarkEntry& left, const BenchmarkEntry& right) {
+                  return left.name < right.name;
+              });
+    if (options.list) {
+        for (const BenchmarkEntry& entry : entries) {
+            std::printf("%s\n", entry.name.c_str());
+        }
+        return 0;
+    }
+
+    BenchmarkRunner runner(options);
+    bool table = !options.json;
+    if (table) {
+        PrintTableHeader(stdout, runner.Cycles());
+    }
+    std::vector<BenchmarkResult> results;
+    for (const BenchmarkEntry& entry : entries) {
+        results.push_back(runner.Run(entry));
+        if (table) {
+            PrintTableRow(stdout, runner.Cycles(), results.back());
+            std::fflush(stdout);
+        }
+    }
+    if (options.json) {
+        PrintJson(stdout, options, runner.Cycles(), results);
+    }
+    if (!options.json_path.empty()) {
+        FILE* out = std::fopen(options.json_path.c_str(), "w");
+        if (out == nullptr) {
+            std::perror(options.json_path.c_str());
+            return 1;
+        }
+        PrintJson(out, options, runner.Cycles(), results);
+        std::fclose(out);
+    }
+    return 0;
+}
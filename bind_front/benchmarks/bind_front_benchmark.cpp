@@ -0,0 +1,30 @@
+#include <benchmark.h>
+#include <bind_front.h>
+
+#include <functional>
+
+namespace {
+
+int Sum3(int a, int b, int c) {
+    return a + b + c;
+}
+
+}  // namespace
+
+BENCHMARK(BindFrontCall) {
+    auto bound = BindFront(&Sum3, 1, 2);
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += bound(static_cast<int>(i));
+    }
+    DoNotOptimize(sum);
+}
+
+BENCHMARK(StdBindFrontCall) {
+    auto bound = std::bind_front(&Sum3, 1, 2);
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += bound(static_cast<int>(i));
+    }
+    DoNotOptimize(sum);
+}
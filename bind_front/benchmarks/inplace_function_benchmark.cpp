@@ -0,0 +1,62 @@
+#include <benchmark.h>
+#include <bind_front.h>
+#include <inplace_function.h>
+
+#include <functional>
+#include <vector>
+
+namespace {
+
+int Sum3(int a, int b, int c) {
+    return a + b + c;
+}
+
+constexpr size_t kFunctions = 64;
+
+}  // namespace
+
+// Building and calling a type-erased callable: InplaceFunction never allocates, std::function
+// does once the capture outgrows its small buffer
+BENCHMARK(InplaceFunctionCreateCall) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        int64_t a = i, b = 2 * i, c = 3 * i;
+        InplaceFunction<int64_t()> function = [a, b, c] { return a + b + c; };
+        sum += function();
+    }
+    DoNotOptimize(sum);
+}
+
+BENCHMARK(StdFunctionCreateCall) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        int64_t a = i, b = 2 * i, c = 3 * i;
+        std::function<int64_t()> function = [a, b, c] { return a + b + c; };
+        sum += function();
+    }
+    DoNotOptimize(sum);
+}
+
+BENCHMARK(InplaceFunctionVectorCall) {
+    std::vector<InplaceFunction<int(int)>> functions;
+    for (size_t i = 0; i < kFunctions; ++i) {
+        functions.emplace_back(BindFront(&Sum3, static_cast<int>(i), 1));
+    }
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += functions[i % kFunctions](static_cast<int>(i));
+    }
+    DoNotOptimize(sum);
+}
+
+BENCHMARK(StdFunctionVectorCall) {
+    std::vector<std::function<int(int)>> functions;
+    for (size_t i = 0; i < kFunctions; ++i) {
+        functions.emplace_back(BindFront(&Sum3, static_cast<int>(i), 1));
+    }
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += functions[i % kFunctions](static_cast<int>(i));
+    }
+    DoNotOptimize(sum);
+}
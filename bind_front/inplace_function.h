@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// `std::function` replacement that never allocates: the callable is stored in `Capacity` bytes
+// inside the object, and a callable that does not fit is a compile error rather than a heap
+// allocation. Good for keeping `BindFront` results in queues and callback slots.
+//
+// Trivially copyable callables (function pointers, lambdas capturing pointers and integers)
+// are moved and copied with a plain `memcpy`; others go through their move or copy
+// constructor. Like the `BindFront` result it usually holds, the call operator is non-const.
+template <class Signature, size_t Capacity, bool Copyable>
+class BasicInplaceFunction;
+
+template <class R, class... Args, size_t Capacity, bool Copyable>
+class BasicInplaceFunction<R(Args...), Capacity, Copyable> {
+private:
+    static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+    struct Operations {
+        R (*invoke)(void* storage, Args&&... args);
+        // Null when the callable is trivially copyable and `memcpy` does the job
+        void (*copy)(void* to, const void* from);
+        // Move-constructs into `to` and destroys `from`. Null as for `copy`
+        void (*relocate)(void* to, void* from);
+        // Null when the callable is trivially destructible
+        void (*destroy)(void* storage);
+    };
+
+    template <class F>
+    static F* Get(void* storage) {
+        return std::launder(static_cast<F*>(storage));
+    }
+
+    template <class F>
+    static R Invoke(void* storage, Args&&... args) {
+        if constexpr (std::is_void_v<R>) {
+            std::invoke(*Get<F>(storage), std::forward<Args>(args)...);
+        } else {
+            return std::invoke(*Get<F>(storage), std::forward<Args>(args)...);
+        }
+    }
+
+    template <class F>
+    static void Copy(void* to, const void* from) {
+        ::new (to) F(*std::launder(static_cast<const F*>(from)));
+    }
+
+    template <class F>
+    static void Relocate(void* to, void* from) {
+        F* source = Get<F>(from);
+        ::new (to) F(std::move(*source));
+        source->~F();
+    }
+
+    template <class F>
+    static void Destroy(void* storage) {
+        Get<F>(storage)->~F();
+    }
+
+    template <class F>
+    static constexpr Operations MakeOperations() {
+        Operations operations{&Invoke<F>, nullptr, nullptr, nullptr};
+        if constexpr (!std::is_trivially_copyable_v<F>) {
+            if constexpr (Copyable) {
+                operations.copy = &Copy<F>;
+            }
+            operations.relocate = &Relocate<F>;
+        }
+        if constexpr (!std::is_trivially_destructible_v<F>) {
+            operations.destroy = &Destroy<F>;
+        }
+        return operations;
+    }
+
+    template <class F>
+    static constexpr Operations kOperations = MakeOperations<F>();
+
+    alignas(kAlignment) unsigned char storage_[Capacity];
+    const Operations* operations_ = nullptr;
+
+    void CopyFrom(const BasicInplaceFunction& other) {
+        if (other.operations_ && other.operations_->copy) {
+            other.operations_->copy(storage_, other.storage_);
+        } else {
+            std::memcpy(storage_, other.storage_, Capacity);
+        }
+        operations_ = other.operations_;
+    }
+
+    void MoveFrom(BasicInplaceFunction& other) noexcept {
+        if (other.operations_ && other.operations_->relocate) {
+            other.operations_->relocate(storage_, other.storage_);
+        } else {
+            std::memcpy(storage_, other.storage_, Capacity);
+        }
+        operations_ = std::exchange(other.operations_, nullptr);
+    }
+
+public:
+    BasicInplaceFunction() = default;
+
+    BasicInplaceFunction(std::nullptr_t) {
+    }
+
+    template <class F, class Stored = std::decay_t<F>>
+        requires(!std::is_same_v<Stored, BasicInplaceFunction> &&
+                 std::is_invocable_r_v<R, Stored&, Args...> &&
+                 (!Copyable || std::is_copy_constructible_v<Stored>))
+    BasicInplaceFunction(F&& f) {
+        static_assert(sizeof(Stored) <= Capacity,
+                      "callable does not fit into BasicInplaceFunction, increase Capacity");
+        static_assert(alignof(Stored) <= kAlignment, "callable is over-aligned");
+        static_assert(std::is_nothrow_move_constructible_v<Stored>,
+                      "callable must be nothrow move constructible");
+        if constexpr (std::is_pointer_v<Stored> || std::is_member_pointer_v<Stored>) {
+            if (f == nullptr) {
+                return;
+            }
+        }
+        ::new (static_cast<void*>(storage_)) Stored(std::forward<F>(f));
+        operations_ = &kOperations<Stored>;
+    }
+
+    BasicInplaceFunction(const BasicInplaceFunction& other)
+        requires Copyable
+    {
+        CopyFrom(other);
+    }
+
+    BasicInplaceFunction(BasicInplaceFunction&& other) noexcept {
+        MoveFrom(other);
+    }
+
+    BasicInplaceFunction& operator=(const BasicInplaceFunction& other)
+        requires Copyable
+    {
+        if (this != &other) {
+            BasicInplaceFunction copy(other);
+            Reset();
+            MoveFrom(copy);
+        }
+        return *this;
+    }
+
+    BasicInplaceFunction& operator=(BasicInplaceFunction&& other) noexcept {
+        if (this != &other) {
+            Reset();
+            MoveFrom(other);
+        }
+        return *this;
+    }
+
+    BasicInplaceFunction& operator=(std::nullptr_t) {
+        Reset();
+        return *this;
+    }
+
+    ~BasicInplaceFunction() {
+        Reset();
+    }
+
+    void Reset() {
+        if (operations_ && operations_->destroy) {
+            operations_->destroy(storage_);
+        }
+        operations_ = nullptr;
+    }
+
+    void Swap(BasicInplaceFunction& other) noexcept {
+        BasicInplaceFunction temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    explicit operator bool() const {
+        return operations_ != nullptr;
+    }
+
+    R operator()(Args... args) {
+        if (!operations_) {
+            throw std::bad_function_call();
+        }
+        return operations_->invoke(storage_, std::forward<Args>(args)...);
+    }
+};
+
+// Four pointers: enough for `BindFront` over a function pointer and a few pointer-sized
+// arguments
+inline constexpr size_t kInplaceFunctionCapacity = 4 * sizeof(void*);
+
+template <class Signature, size_t Capacity = kInplaceFunctionCapacity>
+using InplaceFunction = BasicInplaceFunction<Signature, Capacity, true>;
+
+// Can also hold move-only callables, such as a `BindFront` over a `UniquePtr`
+template <class Signature, size_t Capacity = kInplaceFunctionCapacity>
+using MoveOnlyInplaceFunction = BasicInplaceFunction<Signature, Capacity, false>;
@@ -0,0 +1,58 @@
+#include <bind_front.h>
+#include <inplace_function.h>
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+TEST(BindFront, PrependsBoundArguments) {
+    auto concat = [](const std::string& a, const std::string& b, const std::string& c) {
+        return a + b + c;
+    };
+    auto bound = BindFront(concat, std::string("a"), std::string("b"));
+    EXPECT_EQ(bound(std::string("c")), "abc");
+    EXPECT_EQ(BindFront(std::minus<int>(), 10)(3), 7);
+}
+
+TEST(BindFront, MovesOutMoveOnlyArguments) {
+    auto take = [](std::unique_ptr<int> value, int add) { return *value + add; };
+    auto bound = BindFront(take, std::make_unique<int>(40));
+    EXPECT_EQ(bound(2), 42);
+}
+
+TEST(InplaceFunction, CallsCopiesAndMoves) {
+    int calls = 0;
+    InplaceFunction<int(int)> function = [&calls](int x) {
+        ++calls;
+        return x * 2;
+    };
+    InplaceFunction<int(int)> copy = function;
+    InplaceFunction<int(int)> moved = std::move(function);
+    EXPECT_FALSE(function);
+    EXPECT_EQ(copy(2) + moved(3), 10);
+    EXPECT_EQ(calls, 2);
+    moved = nullptr;
+    EXPECT_THROW(moved(1), std::bad_function_call);
+}
+
+TEST(InplaceFunction, DestroysTheCallable) {
+    auto counter = std::make_shared<int>(0);
+    {
+        InplaceFunction<void()> function = [counter] { ++*counter; };
+        InplaceFunction<void()> other = function;
+        EXPECT_EQ(counter.use_count(), 3);
+        other();
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+    EXPECT_EQ(*counter, 1);
+}
+
+TEST(MoveOnlyInplaceFunction, HoldsMoveOnlyCallables) {
+    MoveOnlyInplaceFunction<int()> function = [value = std::make_unique<int>(7)] {
+        return *value;
+    };
+    MoveOnlyInplaceFunction<int()> moved = std::move(function);
+    EXPECT_EQ(moved(), 7);
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+#include <utility>
+
+// Executor that resumes the coroutine right away, on the thread that released it
+struct InlineExecutor {
+    void operator()(std::coroutine_handle<> handle) const {
+        handle.resume();
+    }
+};
+
+// Mutex for coroutines: `co_await mutex.Lock()` suspends the coroutine instead of blocking
+// the thread. The state is a single word: unlocked, locked, or locked with a stack of
+// waiters. Waiters are the awaiter objects themselves, living in the suspended coroutine
+// frames, so waiting never allocates. `Unlock` hands the lock to the longest waiting
+// coroutine and resumes it through the given executor.
+class AsyncMutex {
+public:
+    class LockAwaiter {
+    public:
+        explicit LockAwaiter(AsyncMutex& mutex) : mutex_(mutex) {
+        }
+
+        bool await_ready() const {
+            return mutex_.TryLock();
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            uintptr_t old_state = mutex_.state_.load(std::memory_order_acquire);
+            while (true) {
+                if (old_state == kUnlocked) {
+                    if (mutex_.state_.compare_exchange_weak(old_state, kLockedNoWaiters,
+                                                            std::memory_order_acquire,
+                                                            std::memory_order_relaxed)) {
+                        return false;
+                    }
+                } else {
+                    next_ = reinterpret_cast<LockAwaiter*>(old_state);
+                    if (mutex_.state_.compare_exchange_weak(
+                            old_state, reinterpret_cast<uintptr_t>(this),
+                            std::memory_order_release, std::memory_order_relaxed)) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        void await_resume() const {
+        }
+
+    private:
+        AsyncMutex& mutex_;
+        std::coroutine_handle<> handle_;
+        LockAwaiter* next_ = nullptr;
+
+        friend class AsyncMutex;
+    };
+
+    AsyncMutex() : state_(kUnlocked) {
+    }
+
+    AsyncMutex(const AsyncMutex&) = delete;
+    AsyncMutex& operator=(const AsyncMutex&) = delete;
+
+    bool TryLock() {
+        uintptr_t expected = kUnlocked;
+        return state_.compare_exchange_strong(expected, kLockedNoWaiters,
+                                              std::memory_order_acquire,
+                                              std::memory_order_relaxed);
+    }
+
+    LockAwaiter Lock() {
+        return LockAwaiter(*this);
+    }
+
+    // `executor(std::coroutine_handle<>)` is called for the coroutine that gets the lock
+    template <class Executor>
+    void Unlock(Executor&& executor) {
+        LockAwaiter* next = waiters_;
+        if (next == nullptr) {
+            uintptr_t expected = kLockedNoWaiters;
+            if (state_.compare_exchange_strong(expected, kUnlocked, std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+                return;
+            }
+            // New waiters are pushed on a stack; reverse it to serve them in arrival order
+            auto* stack =
+                reinterpret_cast<LockAwaiter*>(state_.exchange(kLockedNoWaiters,
+                                                               std::memory_order_acquire));
+            while (stack != nullptr) {
+                LockAwaiter* below = stack->next_;
+                stack->next_ = next;
+                next = stack;
+                stack = below;
+            }
+        }
+        waiters_ = next->next_;
+        std::forward<Executor>(executor)(next->handle_);
+    }
+
+    void Unlock() {
+        Unlock(InlineExecutor());
+    }
+
+private:
+    static constexpr uintptr_t kUnlocked = 1;
+    static constexpr uintptr_t kLockedNoWaiters = 0;
+
+    // `kUnlocked`, `kLockedNoWaiters` or the most recently pushed `LockAwaiter`
+    std::atomic<uintptr_t> state_;
+    // Waiters already taken from `state_`, oldest first; touched only by the lock owner
+    LockAwaiter* waiters_ = nullptr;
+};
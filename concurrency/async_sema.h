@@ -0,0 +1,109 @@
+#pragma once
+
+#include "async_mutex.h"
+
+#include <atomic>
+#include <coroutine>
+#include <mutex>
+#include <utility>
+
+// Semaphore for coroutines: `co_await semaphore.Enter()` suspends the coroutine while no
+// permits are left. `count_` is the number of free permits minus the number of coroutines
+// that want one, so `Enter` and `Leave` are a single atomic operation while permits are
+// available. Only when a coroutine has to wait do both sides take `mutex_` to use the
+// intrusive queue of awaiters.
+class AsyncSemaphore {
+public:
+    class EnterAwaiter {
+    public:
+        explicit EnterAwaiter(AsyncSemaphore& semaphore) : semaphore_(semaphore) {
+        }
+
+        bool await_ready() {
+            return semaphore_.count_.fetch_sub(1, std::memory_order_acquire) > 0;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            handle_ = handle;
+            std::lock_guard<std::mutex> lock(semaphore_.mutex_);
+            // A `Leave` got in between `await_ready` and here and left its permit for us
+            if (semaphore_.pending_ > 0) {
+                --semaphore_.pending_;
+                return false;
+            }
+            if (semaphore_.tail_ != nullptr) {
+                semaphore_.tail_->next_ = this;
+            } else {
+                semaphore_.head_ = this;
+            }
+            semaphore_.tail_ = this;
+            return true;
+        }
+
+        void await_resume() const {
+        }
+
+    private:
+        AsyncSemaphore& semaphore_;
+        std::coroutine_handle<> handle_;
+        EnterAwaiter* next_ = nullptr;
+
+        friend class AsyncSemaphore;
+    };
+
+    explicit AsyncSemaphore(int count) : count_(count) {
+    }
+
+    AsyncSemaphore(const AsyncSemaphore&) = delete;
+    AsyncSemaphore& operator=(const AsyncSemaphore&) = delete;
+
+    bool TryEnter() {
+        int count = count_.load(std::memory_order_relaxed);
+        while (count > 0) {
+            if (count_.compare_exchange_weak(count, count - 1, std::memory_order_acquire,
+                                             std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    EnterAwaiter Enter() {
+        return EnterAwaiter(*this);
+    }
+
+    // If a coroutine is waiting, the permit goes to it and `executor(std::coroutine_handle<>)`
+    // is called to resume it
+    template <class Executor>
+    void Leave(Executor&& executor) {
+        if (count_.fetch_add(1, std::memory_order_release) >= 0) {
+            return;
+        }
+        EnterAwaiter* waiter;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            waiter = head_;
+            if (waiter == nullptr) {
+                ++pending_;
+                return;
+            }
+            head_ = waiter->next_;
+            if (head_ == nullptr) {
+                tail_ = nullptr;
+            }
+        }
+        std::forward<Executor>(executor)(waiter->handle_);
+    }
+
+    void Leave() {
+        Leave(InlineExecutor());
+    }
+
+private:
+    std::atomic<int> count_;
+    std::mutex mutex_;
+    EnterAwaiter* head_ = nullptr;
+    EnterAwaiter* tail_ = nullptr;
+    // Permits handed over by `Leave` to coroutines that are not in the queue yet
+    int pending_ = 0;
+};
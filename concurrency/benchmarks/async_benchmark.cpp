@@ -0,0 +1,136 @@
+#include <async_mutex.h>
+#include <async_sema.h>
+#include <benchmark.h>
+
+#include <coroutine>
+#include <deque>
+#include <exception>
+
+namespace {
+
+// Coroutine that starts right away and frees its frame when it finishes
+struct Task {
+    struct promise_type {
+        Task get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+// Single-threaded scheduler: coroutines handed to it run in FIFO order from `Run`
+struct Scheduler {
+    std::deque<std::coroutine_handle<>> ready;
+
+    void operator()(std::coroutine_handle<> handle) {
+        ready.push_back(handle);
+    }
+
+    auto Yield() {
+        struct Awaiter {
+            Scheduler& scheduler;
+
+            bool await_ready() const {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle) {
+                scheduler(handle);
+            }
+
+            void await_resume() const {
+            }
+        };
+        return Awaiter{*this};
+    }
+
+    void Run() {
+        while (!ready.empty()) {
+            std::coroutine_handle<> handle = ready.front();
+            ready.pop_front();
+            handle.resume();
+        }
+    }
+};
+
+Task LockUnlock(AsyncMutex& mutex, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        co_await mutex.Lock();
+        mutex.Unlock();
+    }
+}
+
+// Holds the lock across a yield, so the other worker is always waiting and every `Unlock`
+// hands the lock over
+Task LockYieldUnlock(AsyncMutex& mutex, Scheduler& scheduler, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        co_await mutex.Lock();
+        co_await scheduler.Yield();
+        mutex.Unlock(scheduler);
+    }
+}
+
+Task EnterLeave(AsyncSemaphore& semaphore, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        co_await semaphore.Enter();
+        semaphore.Leave();
+    }
+}
+
+Task Ping(AsyncSemaphore& ping, AsyncSemaphore& pong, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        ping.Leave();
+        co_await pong.Enter();
+    }
+}
+
+Task Pong(AsyncSemaphore& ping, AsyncSemaphore& pong, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        co_await ping.Enter();
+        pong.Leave();
+    }
+}
+
+}  // namespace
+
+BENCHMARK(AsyncMutexUncontended) {
+    AsyncMutex mutex;
+    LockUnlock(mutex, iterations);
+}
+
+// Two coroutines on one thread taking turns; compare with `MutexContended/threads:2`
+BENCHMARK(AsyncMutexHandoff) {
+    AsyncMutex mutex;
+    Scheduler scheduler;
+    LockYieldUnlock(mutex, scheduler, iterations - iterations / 2);
+    LockYieldUnlock(mutex, scheduler, iterations / 2);
+    scheduler.Run();
+}
+
+BENCHMARK(AsyncSemaphoreEnterLeave) {
+    AsyncSemaphore semaphore(1);
+    EnterLeave(semaphore, iterations);
+}
+
+// One permit passed back and forth: every round suspends `Pong` and resumes it from `Leave`;
+// compare with the two threads of `SemaphorePingPong`
+BENCHMARK(AsyncSemaphorePingPong) {
+    AsyncSemaphore ping(0);
+    AsyncSemaphore pong(0);
+    Pong(ping, pong, iterations);
+    Ping(ping, pong, iterations);
+}
@@ -0,0 +1,99 @@
+#include <benchmark.h>
+#include <mutex.h>
+#include <sema.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Splits `iterations` between `threads` threads running `body(count)` and waits for them
+template <class Body>
+void RunThreads(size_t iterations, int threads, Body body) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        size_t count = iterations / threads + (static_cast<size_t>(t) < iterations % threads);
+        workers.emplace_back([&body, count] { body(count); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+template <class Lockable>
+void LockUnlock(Lockable& mutex) {
+    if constexpr (requires { mutex.Lock(); }) {
+        mutex.Lock();
+        mutex.Unlock();
+    } else {
+        mutex.lock();
+        mutex.unlock();
+    }
+}
+
+template <class Lockable>
+void Contended(size_t iterations, int threads) {
+    Lockable mutex;
+    size_t counter = 0;
+    RunThreads(iterations, threads, [&](size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            LockUnlock(mutex);
+            DoNotOptimize(++counter);
+        }
+    });
+}
+
+[[maybe_unused]] const bool kContendedRegistered = [] {
+    for (int threads : {2, 4}) {
+        std::string suffix = "/threads:" + std::to_string(threads);
+        RegisterBenchmark("MutexContended" + suffix,
+                          [threads](size_t iterations) { Contended<Mutex>(iterations, threads); });
+        RegisterBenchmark("StdMutexContended" + suffix, [threads](size_t iterations) {
+            Contended<std::mutex>(iterations, threads);
+        });
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK(MutexUncontended) {
+    Mutex mutex;
+    for (size_t i = 0; i < iterations; ++i) {
+        LockUnlock(mutex);
+    }
+}
+
+BENCHMARK(StdMutexUncontended) {
+    std::mutex mutex;
+    for (size_t i = 0; i < iterations; ++i) {
+        LockUnlock(mutex);
+    }
+}
+
+BENCHMARK(SemaphoreEnterLeave) {
+    Semaphore semaphore(1);
+    for (size_t i = 0; i < iterations; ++i) {
+        semaphore.Enter();
+        semaphore.Leave();
+    }
+}
+
+// Two threads passing one permit back and forth
+BENCHMARK(SemaphorePingPong) {
+    Semaphore ping(0);
+    Semaphore pong(0);
+    std::thread other([&] {
+        for (size_t i = 0; i < iterations; ++i) {
+            ping.Enter();
+            pong.Leave();
+        }
+    });
+    for (size_t i = 0; i < iterations; ++i) {
+        ping.Leave();
+        pong.Enter();
+    }
+    other.join();
+}
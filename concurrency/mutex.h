@@ -7,15 +7,15 @@
 
 #include <atomic>
 
-void FutexWait(std::atomic<int> *value, int expected_value) {
+inline void FutexWait(std::atomic<int> *value, int expected_value) {
     syscall(SYS_futex, value, FUTEX_WAIT_PRIVATE, expected_value, nullptr, nullptr, 0);
 }
 
-void FutexWake(std::atomic<int> *value, int count) {
+inline void FutexWake(std::atomic<int> *value, int count) {
     syscall(SYS_futex, value, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
 }
 
-int Cmpxchg(std::atomic<int> *val, int expected, int desired) {
+inline int Cmpxchg(std::atomic<int> *val, int expected, int desired) {
     std::atomic_compare_exchange_strong(val, &expected, desired);
     return expected;
 }
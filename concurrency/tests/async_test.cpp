@@ -0,0 +1,241 @@
+#include <async_mutex.h>
+#include <async_sema.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Coroutine that starts right away and frees its frame when it finishes
+struct Task {
+    struct promise_type {
+        Task get_return_object() {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {
+        }
+
+        void unhandled_exception() {
+            std::terminate();
+        }
+    };
+};
+
+// Executor that only queues the coroutines; `Run` resumes them in order
+struct QueueExecutor {
+    std::deque<std::coroutine_handle<>>* queue;
+
+    void operator()(std::coroutine_handle<> handle) const {
+        queue->push_back(handle);
+    }
+
+    void Run() const {
+        while (!queue->empty()) {
+            std::coroutine_handle<> handle = queue->front();
+            queue->pop_front();
+            handle.resume();
+        }
+    }
+};
+
+Task LockAndRecord(AsyncMutex& mutex, std::vector<int>& order, int id) {
+    co_await mutex.Lock();
+    order.push_back(id);
+    mutex.Unlock();
+}
+
+Task LockAndHold(AsyncMutex& mutex, bool& locked) {
+    co_await mutex.Lock();
+    locked = true;
+}
+
+Task EnterAndRecord(AsyncSemaphore& semaphore, std::vector<int>& order, int id) {
+    co_await semaphore.Enter();
+    order.push_back(id);
+}
+
+Task LockAndRecordQueued(AsyncMutex& mutex, QueueExecutor executor, std::vector<int>& order,
+                         int id) {
+    co_await mutex.Lock();
+    order.push_back(id);
+    mutex.Unlock(executor);
+}
+
+Task Increment(AsyncMutex& mutex, int& counter, int times) {
+    for (int i = 0; i < times; ++i) {
+        co_await mutex.Lock();
+        ++counter;
+        mutex.Unlock();
+    }
+}
+
+Task EnterAndLeave(AsyncSemaphore& semaphore, std::atomic<int>& inside, std::atomic<int>& peak,
+                   int times) {
+    for (int i = 0; i < times; ++i) {
+        co_await semaphore.Enter();
+        int now = ++inside;
+        int seen = peak.load();
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+        --inside;
+        semaphore.Leave();
+    }
+}
+
+}  // namespace
+
+TEST(AsyncMutex, FreeLockDoesNotSuspend) {
+    AsyncMutex mutex;
+    bool locked = false;
+    LockAndHold(mutex, locked);
+    EXPECT_TRUE(locked);
+    EXPECT_FALSE(mutex.TryLock());
+    mutex.Unlock();
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+TEST(AsyncMutex, WaitsWhileHeld) {
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.TryLock());
+    bool locked = false;
+    LockAndHold(mutex, locked);
+    EXPECT_FALSE(locked);
+    // The lock goes straight to the waiter, it never becomes free in between
+    mutex.Unlock();
+    EXPECT_TRUE(locked);
+    EXPECT_FALSE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+TEST(AsyncMutex, WaitersGetTheLockInArrivalOrder) {
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.TryLock());
+    std::vector<int> order;
+    for (int id = 0; id < 5; ++id) {
+        LockAndRecord(mutex, order, id);
+    }
+    EXPECT_TRUE(order.empty());
+    mutex.Unlock();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3, 4}));
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+TEST(AsyncMutex, LateWaitersQueueBehindEarlierOnes) {
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.TryLock());
+    std::deque<std::coroutine_handle<>> queue;
+    QueueExecutor executor{&queue};
+    std::vector<int> order;
+    LockAndRecordQueued(mutex, executor, order, 0);
+    LockAndRecordQueued(mutex, executor, order, 1);
+    mutex.Unlock(executor);
+    // 0 owns the lock but has not run yet; 2 arrives after 1, which is already taken from
+    // the stack of new waiters
+    LockAndRecordQueued(mutex, executor, order, 2);
+    executor.Run();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+    EXPECT_TRUE(mutex.TryLock());
+    mutex.Unlock();
+}
+
+TEST(AsyncMutex, ExecutorDecidesWhereTheWaiterResumes) {
+    AsyncMutex mutex;
+    ASSERT_TRUE(mutex.TryLock());
+    std::deque<std::coroutine_handle<>> queue;
+    QueueExecutor executor{&queue};
+    std::vector<int> order;
+    LockAndRecordQueued(mutex, executor, order, 0);
+    mutex.Unlock(executor);
+    EXPECT_TRUE(order.empty());
+    ASSERT_EQ(queue.size(), 1u);
+    executor.Run();
+    EXPECT_EQ(order, (std::vector<int>{0}));
+}
+
+TEST(AsyncMutex, ProtectsACounterAcrossThreads) {
+    AsyncMutex mutex;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            // Two coroutines per thread, so some always wait; a waiter may be resumed by an
+            // `Unlock` on another thread
+            Increment(mutex, counter, 5000);
+            Increment(mutex, counter, 5000);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter, 40000);
+    EXPECT_TRUE(mutex.TryLock());
+}
+
+TEST(AsyncSemaphore, HandsOutPermitsThenQueues) {
+    AsyncSemaphore semaphore(2);
+    std::vector<int> order;
+    for (int id = 0; id < 4; ++id) {
+        EnterAndRecord(semaphore, order, id);
+    }
+    EXPECT_EQ(order, (std::vector<int>{0, 1}));
+    EXPECT_FALSE(semaphore.TryEnter());
+    semaphore.Leave();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2}));
+    semaphore.Leave();
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 3}));
+    semaphore.Leave();
+    EXPECT_TRUE(semaphore.TryEnter());
+    EXPECT_FALSE(semaphore.TryEnter());
+}
+
+TEST(AsyncSemaphore, ExecutorDecidesWhereTheWaiterResumes) {
+    AsyncSemaphore semaphore(0);
+    std::deque<std::coroutine_handle<>> queue;
+    QueueExecutor executor{&queue};
+    std::vector<int> order;
+    EnterAndRecord(semaphore, order, 0);
+    semaphore.Leave(executor);
+    EXPECT_TRUE(order.empty());
+    executor.Run();
+    EXPECT_EQ(order, (std::vector<int>{0}));
+    EXPECT_FALSE(semaphore.TryEnter());
+}
+
+TEST(AsyncSemaphore, LimitsConcurrencyAcrossThreads) {
+    constexpr int kPermits = 2;
+    AsyncSemaphore semaphore(kPermits);
+    std::atomic<int> inside = 0;
+    std::atomic<int> peak = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            EnterAndLeave(semaphore, inside, peak, 2000);
+            EnterAndLeave(semaphore, inside, peak, 2000);
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(peak.load(), kPermits);
+    for (int i = 0; i < kPermits; ++i) {
+        EXPECT_TRUE(semaphore.TryEnter());
+    }
+    EXPECT_FALSE(semaphore.TryEnter());
+}
@@ -0,0 +1,59 @@
+#include <mutex.h>
+#include <sema.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(Mutex, ProtectsACounter) {
+    Mutex mutex;
+    int counter = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 20000; ++i) {
+                mutex.Lock();
+                ++counter;
+                mutex.Unlock();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(counter, 80000);
+}
+
+TEST(Semaphore, LimitsConcurrency) {
+    Semaphore semaphore(2);
+    std::atomic<int> inside = 0;
+    std::atomic<int> peak = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 6; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 200; ++i) {
+                semaphore.Enter();
+                int now = ++inside;
+                int seen = peak.load();
+                while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+                }
+                --inside;
+                semaphore.Leave();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_LE(peak.load(), 2);
+    EXPECT_GE(peak.load(), 1);
+}
+
+TEST(Semaphore, CallbackSeesTheCount) {
+    Semaphore semaphore(3);
+    int seen = -1;
+    semaphore.Enter([&seen](int& value) { seen = value--; });
+    EXPECT_EQ(seen, 3);
+}
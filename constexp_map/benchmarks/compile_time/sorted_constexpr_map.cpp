@@ -0,0 +1,28 @@
+// Compiled, never run, by the constexp_map_compile_time target: each SortedConstexprMap size is
+// compiled twice, with and without SORT, and the difference is the compile time of the sort
+
+#include <sorted_constexpr_map.h>
+
+#include <array>
+#include <utility>
+
+namespace {
+
+constexpr std::array<std::pair<int, int>, MAP_SIZE> MakeShuffledItems() {
+    std::array<std::pair<int, int>, MAP_SIZE> items;
+    for (size_t i = 0; i < MAP_SIZE; ++i) {
+        auto index = static_cast<int>((i * 2654435761u) % MAP_SIZE);
+        items[i] = {index * 7 + 3, index};
+    }
+    return items;
+}
+
+constexpr auto kItems = MakeShuffledItems();
+static_assert(kItems[0].first == 3);
+
+#ifdef SORT
+constexpr SortedConstexprMap<int, int, MAP_SIZE> kSorted(kItems);
+static_assert(kSorted.GetByIndex(MAP_SIZE - 1).first == (MAP_SIZE - 1) * 7 + 3);
+#endif
+
+}  // namespace
@@ -0,0 +1,59 @@
+#include <benchmark.h>
+#include <constexpr_map.h>
+#include <string_constexpr_map.h>
+
+#include <array>
+#include <string_view>
+
+namespace {
+
+constexpr int kSize = 32;
+
+constexpr ConstexprMap<int, int, kSize> MakeMap() {
+    ConstexprMap<int, int, kSize> map;
+    for (int i = 0; i < kSize; ++i) {
+        map[i * 7 + 3] = i;
+    }
+    return map;
+}
+
+constexpr auto kMap = MakeMap();
+
+constexpr auto kStrings = MakeConstexprMap<int>({{"GET", 0},
+                                                 {"PUT", 1},
+                                                 {"POST", 2},
+                                                 {"HEAD", 3},
+                                                 {"DELETE", 4},
+                                                 {"OPTIONS", 5},
+                                                 {"PATCH", 6},
+                                                 {"TRACE", 7}});
+constexpr std::array<std::string_view, 8> kStringKeys = {"GET",    "PUT",     "POST",  "HEAD",
+                                                         "DELETE", "OPTIONS", "PATCH", "TRACE"};
+
+// Keys that hit, in an order the branch predictor cannot learn from the index alone
+int KeyAt(size_t i) {
+    return static_cast<int>((i * 11) % kSize) * 7 + 3;
+}
+
+template <class Map>
+void Lookups(const Map& map, size_t iterations) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += map[KeyAt(i)];
+    }
+    DoNotOptimize(sum);
+}
+
+}  // namespace
+
+BENCHMARK(ConstexprMapLookup) {
+    Lookups(kMap, iterations);
+}
+
+BENCHMARK(StringConstexprMapLookup) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += kStrings[kStringKeys[(i * 5) % kStringKeys.size()]];
+    }
+    DoNotOptimize(sum);
+}
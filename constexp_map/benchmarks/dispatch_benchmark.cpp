@@ -0,0 +1,129 @@
+#include <benchmark.h>
+#include <constexpr_map.h>
+#include <dispatch.h>
+
+#include <array>
+#include <functional>
+#include <unordered_map>
+
+namespace {
+
+int Add1(int x) {
+    return x + 1;
+}
+
+int Add2(int x) {
+    return x + 2;
+}
+
+int Add3(int x) {
+    return x + 3;
+}
+
+int Add4(int x) {
+    return x + 4;
+}
+
+constexpr std::array<int (*)(int), 4> kFunctions = {&Add1, &Add2, &Add3, &Add4};
+
+// Keys 0..3: a jump table
+constexpr ConstexprMap<int, int (*)(int), 4> MakeDenseHandlers() {
+    ConstexprMap<int, int (*)(int), 4> map;
+    for (int key = 0; key < 4; ++key) {
+        map[key] = kFunctions[key];
+    }
+    return map;
+}
+
+// Keys spread over a wide range: a decision tree
+constexpr std::array<int, 8> kSparseKeys = {3, 40, 512, 1000, 7777, 65536, 100000, 1 << 24};
+
+constexpr ConstexprMap<int, int (*)(int), 8> MakeSparseHandlers() {
+    ConstexprMap<int, int (*)(int), 8> map;
+    for (size_t i = 0; i < kSparseKeys.size(); ++i) {
+        map[kSparseKeys[i]] = kFunctions[i % kFunctions.size()];
+    }
+    return map;
+}
+
+constexpr auto kDenseHandlers = MakeDenseHandlers();
+constexpr auto kSparseHandlers = MakeSparseHandlers();
+
+// The runtime equivalent: a hash map of type-erased handlers
+template <const auto& Map>
+std::unordered_map<int, std::function<int(int)>> MakeUnorderedHandlers() {
+    std::unordered_map<int, std::function<int(int)>> handlers;
+    for (size_t i = 0; i < Map.Size(); ++i) {
+        handlers.emplace(Map.GetByIndex(i).first, Map.GetByIndex(i).second);
+    }
+    return handlers;
+}
+
+// Hits, with one miss in five
+int DenseKeyAt(size_t i) {
+    return static_cast<int>((i * 3) % 5);
+}
+
+// Hits, with one miss in nine
+int SparseKeyAt(size_t i) {
+    size_t at = (i * 5) % (kSparseKeys.size() + 1);
+    return at < kSparseKeys.size() ? kSparseKeys[at] : 12345;
+}
+
+template <const auto& Map, int (*KeyAt)(size_t)>
+void Dispatched(size_t iterations) {
+    int64_t sum = 0;
+    auto fallback = [](int, int x) { return x; };
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += Dispatch<Map>(KeyAt(i), fallback, static_cast<int>(i));
+    }
+    DoNotOptimize(sum);
+}
+
+// The same calls through the function pointers stored in the map
+template <const auto& Map, int (*KeyAt)(size_t)>
+void Indirect(size_t iterations) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        int key = KeyAt(i);
+        sum += Map.Find(key) ? Map[key](static_cast<int>(i)) : static_cast<int>(i);
+    }
+    DoNotOptimize(sum);
+}
+
+template <const auto& Map, int (*KeyAt)(size_t)>
+void Unordered(size_t iterations) {
+    static const auto handlers = MakeUnorderedHandlers<Map>();
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        auto it = handlers.find(KeyAt(i));
+        sum += it != handlers.end() ? it->second(static_cast<int>(i)) : static_cast<int>(i);
+    }
+    DoNotOptimize(sum);
+}
+
+}  // namespace
+
+BENCHMARK(DispatchJumpTable) {
+    Dispatched<kDenseHandlers, DenseKeyAt>(iterations);
+}
+
+BENCHMARK(IndirectCallThroughMap) {
+    Indirect<kDenseHandlers, DenseKeyAt>(iterations);
+}
+
+BENCHMARK(UnorderedMapStdFunction) {
+    Unordered<kDenseHandlers, DenseKeyAt>(iterations);
+}
+
+BENCHMARK(DispatchDecisionTree) {
+    Dispatched<kSparseHandlers, SparseKeyAt>(iterations);
+}
+
+BENCHMARK(IndirectCallThroughSparseMap) {
+    Indirect<kSparseHandlers, SparseKeyAt>(iterations);
+}
+
+BENCHMARK(UnorderedMapStdFunctionSparse) {
+    Unordered<kSparseHandlers, SparseKeyAt>(iterations);
+}
@@ -0,0 +1,68 @@
+#include <benchmark.h>
+#include <constexpr_map.h>
+#include <frozen_hash_map.h>
+
+#include <array>
+#include <string>
+#include <utility>
+
+namespace {
+
+template <size_t Size>
+constexpr std::array<std::pair<int, int>, Size> MakeItems() {
+    std::array<std::pair<int, int>, Size> items;
+    for (size_t i = 0; i < Size; ++i) {
+        items[i] = {static_cast<int>(i) * 7 + 3, static_cast<int>(i)};
+    }
+    return items;
+}
+
+// Filling a ConstexprMap costs a linear scan per key, which at a thousand keys runs into the
+// compiler's constexpr operation limit: the linear map is built at startup, by a function that
+// is deliberately not constexpr (GCC would otherwise spend a minute trying to constant-initialize
+// it), and the frozen one from the plain array at compile time
+template <size_t Size>
+ConstexprMap<int, int, Size> MakeLinear() {
+    ConstexprMap<int, int, Size> map;
+    for (size_t i = 0; i < Size; ++i) {
+        map[static_cast<int>(i) * 7 + 3] = static_cast<int>(i);
+    }
+    return map;
+}
+
+template <size_t Size>
+const ConstexprMap<int, int, Size> kLinear = MakeLinear<Size>();
+
+template <size_t Size>
+constexpr FrozenHashMap<int, int, Size> kFrozen(MakeItems<Size>());
+
+// Keys that hit, in an order the branch predictor cannot learn from the index alone
+template <size_t Size, class Map>
+void Lookups(const Map& map, size_t iterations) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += map[static_cast<int>((i * 11) % Size) * 7 + 3];
+    }
+    DoNotOptimize(sum);
+}
+
+template <size_t Size>
+void RegisterSize() {
+    std::string suffix = "/size:" + std::to_string(Size);
+    RegisterBenchmark("FrozenHashMapLookup" + suffix,
+                      [](size_t iterations) { Lookups<Size>(kFrozen<Size>, iterations); });
+    RegisterBenchmark("LinearConstexprMapLookup" + suffix,
+                      [](size_t iterations) { Lookups<Size>(kLinear<Size>, iterations); });
+}
+
+[[maybe_unused]] const bool kLookupsRegistered = [] {
+    RegisterSize<8>();
+    RegisterSize<32>();
+    RegisterSize<128>();
+    RegisterSize<512>();
+    RegisterSize<1024>();
+    RegisterSize<4096>();
+    return true;
+}();
+
+}  // namespace
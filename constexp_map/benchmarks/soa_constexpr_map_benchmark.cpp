@@ -0,0 +1,59 @@
+#include <benchmark.h>
+#include <constexpr_map.h>
+#include <soa_constexpr_map.h>
+
+#include <cstdint>
+#include <string>
+
+namespace {
+
+// The same keys in both layouts, so the sweep compares the SIMD scan over packed keys with the
+// scalar scan over key-value pairs
+template <class Map, class K, int Size>
+Map MakeMap() {
+    Map map;
+    for (int i = 0; i < Size; ++i) {
+        map[static_cast<K>(i * 3 + 1)] = i;
+    }
+    return map;
+}
+
+// Keys that hit, in an order the branch predictor cannot learn from the index alone
+template <class Map, class K, int Size>
+void Lookups(size_t iterations) {
+    static const Map kMap = MakeMap<Map, K, Size>();
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += kMap[static_cast<K>(static_cast<int>((i * 11) % Size) * 3 + 1)];
+    }
+    DoNotOptimize(sum);
+}
+
+template <class K, int Size>
+void RegisterSize() {
+    std::string suffix = "/bytes:" + std::to_string(sizeof(K)) + "/size:" + std::to_string(Size);
+    RegisterBenchmark("SoaConstexprMapLookup" + suffix,
+                      Lookups<SoaConstexprMap<K, int, Size>, K, Size>);
+    RegisterBenchmark("ConstexprMapLookup" + suffix, Lookups<ConstexprMap<K, int, Size>, K, Size>);
+}
+
+// Sizes stay below 256 / 3 for one-byte keys, which could not hold more distinct values
+template <class K>
+void RegisterWidth() {
+    RegisterSize<K, 4>();
+    RegisterSize<K, 16>();
+    RegisterSize<K, 64>();
+    if constexpr (sizeof(K) > 1) {
+        RegisterSize<K, 256>();
+    }
+}
+
+[[maybe_unused]] const bool kLookupsRegistered = [] {
+    RegisterWidth<uint8_t>();
+    RegisterWidth<uint16_t>();
+    RegisterWidth<uint32_t>();
+    RegisterWidth<uint64_t>();
+    return true;
+}();
+
+}  // namespace
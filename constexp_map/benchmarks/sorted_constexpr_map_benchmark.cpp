@@ -0,0 +1,53 @@
+#include <benchmark.h>
+#include <sorted_constexpr_map.h>
+
+#include <array>
+#include <string>
+#include <utility>
+
+// Lookups only; what the sort costs the compiler is measured by the constexp_map_compile_time
+// target, see compile_time/sorted_constexpr_map.cpp
+
+namespace {
+
+// The keys of frozen_hash_map_benchmark.cpp, stored out of order so the constructor has to sort
+template <size_t Size>
+constexpr std::array<std::pair<int, int>, Size> MakeShuffledItems() {
+    std::array<std::pair<int, int>, Size> items;
+    for (size_t i = 0; i < Size; ++i) {
+        auto index = static_cast<int>((i * 2654435761u) % Size);
+        items[i] = {index * 7 + 3, index};
+    }
+    return items;
+}
+
+template <size_t Size>
+constexpr SortedConstexprMap<int, int, Size> kSorted(MakeShuffledItems<Size>());
+
+// Keys that hit, in an order the branch predictor cannot learn from the index alone
+template <size_t Size>
+void Lookups(size_t iterations) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += kSorted<Size>[static_cast<int>((i * 11) % Size) * 7 + 3];
+    }
+    DoNotOptimize(sum);
+}
+
+// The same sizes as LinearConstexprMapLookup and FrozenHashMapLookup
+template <size_t Size>
+void RegisterSize() {
+    RegisterBenchmark("SortedConstexprMapLookup/size:" + std::to_string(Size), Lookups<Size>);
+}
+
+[[maybe_unused]] const bool kLookupsRegistered = [] {
+    RegisterSize<8>();
+    RegisterSize<32>();
+    RegisterSize<128>();
+    RegisterSize<512>();
+    RegisterSize<1024>();
+    RegisterSize<4096>();
+    return true;
+}();
+
+}  // namespace
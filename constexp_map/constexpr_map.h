@@ -41,7 +41,7 @@ public:
     }
 
     constexpr bool Erase(const K& key) {
-        for (auto it = data_.begin(); it != data_.end(); ++it) {
+        for (auto it = data_.begin(); it != data_.begin() + size_; ++it) {
             if (it->first == key) {
                 for (auto jt = it; jt + 1 != data_.end(); ++jt) {
                     jt->swap(*(jt + 1));
@@ -54,7 +54,7 @@ public:
     }
 
     constexpr bool Find(const K& key) const {
-        for (auto it = data_.begin(); it != data_.end(); ++it) {
+        for (auto it = data_.begin(); it != data_.begin() + size_; ++it) {
             if (it->first == key) {
                 return true;
             }
@@ -70,25 +70,13 @@ public:
         if (pos >= size_) {
             throw std::runtime_error("ConstexprMap Overflow");
         }
-        size_t i = 0;
-        for (auto& elem : data_) {
-            if (i == pos) {
-                return elem;
-            }
-            ++i;
-        }
+        return data_[pos];
     }
 
     constexpr const std::pair<K, V>& GetByIndex(size_t pos) const {
-        if (pos >= data_.size()) {
+        if (pos >= size_) {
             throw std::runtime_error("ConstexprMap Overflow");
         }
-        size_t i = 0;
-        for (const auto& elem : data_) {
-            if (i == pos) {
-                return elem;
-            }
-            ++i;
-        }
+        return data_[pos];
     }
 };
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <sort.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Turns a `constexpr` map from integral or enum keys to handlers into direct code. Dense keys
+// get a jump table indexed by `key - min`, sparse keys a binary decision tree over the sorted
+// keys; misses go to a fallback. Each handler is read from the map as a compile-time
+// constant, so calls through function pointers become direct calls that can be inlined.
+//
+//     static constexpr auto kHandlers = MakeHandlers();    // ConstexprMap<Op, int (*)(int)>
+//     int result = Dispatch<kHandlers>(op, [](Op, int) { return -1; }, 42);
+template <const auto& Map>
+class Dispatcher {
+private:
+    using Entry = std::remove_cvref_t<decltype(Map.GetByIndex(0))>;
+    using Key = typename Entry::first_type;
+    using Handler = typename Entry::second_type;
+
+    static_assert(std::is_integral_v<Key> || std::is_enum_v<Key>,
+                  "Dispatch needs integral or enum keys");
+
+    using Integer =
+        typename std::conditional_t<std::is_enum_v<Key>, std::underlying_type<Key>,
+                                    std::type_identity<Key>>::type;
+    using Unsigned = std::make_unsigned_t<Integer>;
+
+    static constexpr size_t kSize = Map.Size();
+
+    static constexpr auto SortKeys() {
+        std::array<std::pair<Integer, size_t>, kSize> keys{};
+        for (size_t i = 0; i < kSize; ++i) {
+            keys[i] = {static_cast<Integer>(Map.GetByIndex(i).first), i};
+        }
+        MergeSort(keys, kSize, [](const auto& left, const auto& right) {
+            return left.first < right.first;
+        });
+        return keys;
+    }
+
+    static constexpr auto kSorted = SortKeys();
+
+    // Number of values between the smallest and the largest key, saturated at `SIZE_MAX`
+    static constexpr size_t KeyRange() {
+        if constexpr (kSize == 0) {
+            return 0;
+        } else {
+            Unsigned span = static_cast<Unsigned>(static_cast<Unsigned>(kSorted.back().first) -
+                                                  static_cast<Unsigned>(kSorted.front().first));
+            return span >= SIZE_MAX ? SIZE_MAX : static_cast<size_t>(span) + 1;
+        }
+    }
+
+    static constexpr size_t kMinDenseRange = 8;
+    // Jump table when at least half of its entries are real handlers
+    static constexpr bool kDense =
+        kSize > 0 && KeyRange() <= std::max(2 * kSize, kMinDenseRange);
+    static constexpr size_t kTableSize = kDense ? KeyRange() : 0;
+
+    // Map index for every offset from the smallest key, `kSize` for holes
+    static constexpr auto BuildOffsets() {
+        std::array<size_t, kTableSize> offsets{};
+        if constexpr (kDense) {
+            offsets.fill(kSize);
+            for (const auto& [key, index] : kSorted) {
+                offsets[static_cast<Unsigned>(static_cast<Unsigned>(key) -
+                                              static_cast<Unsigned>(kSorted.front().first))] =
+                    index;
+            }
+        }
+        return offsets;
+    }
+
+    template <class R, class Fallback, class... Args>
+    struct Calls {
+        using Function = R (*)(Key, Fallback&, Args&&...);
+
+        template <size_t Index>
+        static R Hit(Key, Fallback&, Args&&... args) {
+            constexpr Handler handler = Map.GetByIndex(Index).second;
+            return std::invoke(handler, std::forward<Args>(args)...);
+        }
+
+        static R Miss(Key key, Fallback& fallback, Args&&... args) {
+            return std::invoke(fallback, key, std::forward<Args>(args)...);
+        }
+
+        template <size_t Index>
+        static constexpr Function Slot() {
+            if constexpr (Index == kSize) {
+                return &Miss;
+            } else {
+                return &Hit<Index>;
+            }
+        }
+
+        template <size_t... Offsets>
+        static constexpr std::array<Function, kTableSize> MakeTable(
+            std::index_sequence<Offsets...>) {
+            [[maybe_unused]] constexpr auto offsets = BuildOffsets();
+            return {Slot<offsets[Offsets]>()...};
+        }
+
+        static constexpr auto kTable = MakeTable(std::make_index_sequence<kTableSize>());
+
+        template <size_t Low, size_t High>
+        static R Search(Integer value, Key key, Fallback& fallback, Args&&... args) {
+            if constexpr (Low == High) {
+                return Miss(key, fallback, std::forward<Args>(args)...);
+            } else {
+                constexpr size_t kMid = Low + (High - Low) / 2;
+                constexpr Integer kPivot = kSorted[kMid].first;
+                if (value < kPivot) {
+                    return Search<Low, kMid>(value, key, fallback, std::forward<Args>(args)...);
+                }
+                if (kPivot < value) {
+                    return Search<kMid + 1, High>(value, key, fallback,
+                                                  std::forward<Args>(args)...);
+                }
+                return Hit<kSorted[kMid].second>(key, fallback, std::forward<Args>(args)...);
+            }
+        }
+    };
+
+public:
+    template <class Fallback, class... Args>
+    static decltype(auto) Call(Key key, Fallback&& fallback, Args&&... args) {
+        using R = std::invoke_result_t<const Handler&, Args&&...>;
+        using Impl = Calls<R, std::remove_reference_t<Fallback>, Args...>;
+        auto value = static_cast<Integer>(key);
+        if constexpr (kDense) {
+            auto offset = static_cast<Unsigned>(static_cast<Unsigned>(value) -
+                                                static_cast<Unsigned>(kSorted.front().first));
+            if (offset < kTableSize) {
+                return Impl::kTable[offset](key, fallback, std::forward<Args>(args)...);
+            }
+            return Impl::Miss(key, fallback, std::forward<Args>(args)...);
+        } else {
+            return Impl::template Search<0, kSize>(value, key, fallback,
+                                                   std::forward<Args>(args)...);
+        }
+    }
+};
+
+// Calls the handler stored under `key` in `Map` with `args`, or `fallback(key, args...)` when
+// there is none. `Map` must be a `constexpr` object with static storage duration.
+template <const auto& Map, class Key, class Fallback, class... Args>
+decltype(auto) Dispatch(Key key, Fallback&& fallback, Args&&... args) {
+    return Dispatcher<Map>::Call(key, std::forward<Fallback>(fallback),
+                                 std::forward<Args>(args)...);
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <constexpr_map.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+constexpr uint64_t FrozenMix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Seeded hash usable in constant expressions. Specialize it for other key types.
+template <class K>
+struct FrozenHash;
+
+template <class K>
+    requires std::is_integral_v<K> || std::is_enum_v<K>
+struct FrozenHash<K> {
+    constexpr uint64_t operator()(const K& key, uint64_t seed) const {
+        return FrozenMix(static_cast<uint64_t>(key) ^ (seed * 0x9e3779b97f4a7c15ULL));
+    }
+};
+
+template <>
+struct FrozenHash<std::string_view> {
+    constexpr uint64_t operator()(std::string_view key, uint64_t seed) const {
+        uint64_t hash = 0xcbf29ce484222325ULL ^ seed;
+        for (char c : key) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ULL;
+        }
+        return FrozenMix(hash);
+    }
+};
+
+// Immutable hash map with a perfect hash found at compile time ("hash and displace"): keys
+// are spread over buckets by one hash, and every bucket gets its own seed, searched for while
+// building, that sends its keys to free slots of the table. A lookup is two hashes, two array
+// reads and one key comparison, both in constant expressions and at runtime.
+template <class K, class V, size_t N, class Hash = FrozenHash<K>>
+class FrozenHashMap {
+private:
+    static constexpr size_t kTableSize = std::bit_ceil(std::max<size_t>(N, 1));
+    static constexpr uint64_t kBucketSeed = 0x51ed270b27a1f3c5ULL;
+    // Buckets with a single key store its slot directly instead of a seed
+    static constexpr uint64_t kDirectSlot = uint64_t(1) << 63;
+    static constexpr size_t kEmpty = std::numeric_limits<size_t>::max();
+    static constexpr uint64_t kMaxSeed = uint64_t(1) << 24;
+
+    std::array<std::pair<K, V>, N> items_;
+    size_t size_;
+    std::array<uint64_t, kTableSize> seeds_;
+    std::array<size_t, kTableSize> slots_;
+
+    static constexpr size_t BucketOf(const K& key) {
+        return Hash()(key, kBucketSeed) & (kTableSize - 1);
+    }
+
+    static constexpr size_t SlotOf(const K& key, uint64_t seed) {
+        if (seed & kDirectSlot) {
+            return seed & ~kDirectSlot;
+        }
+        return Hash()(key, seed) & (kTableSize - 1);
+    }
+
+    constexpr size_t IndexOf(const K& key) const {
+        size_t index = slots_[SlotOf(key, seeds_[BucketOf(key)])];
+        if (index != kEmpty && items_[index].first == key) {
+            return index;
+        }
+        return kEmpty;
+    }
+
+    constexpr void Build();
+
+public:
+    constexpr FrozenHashMap(const std::array<std::pair<K, V>, N>& items, size_t size = N)
+        : items_(items), size_(size), seeds_(), slots_() {
+        if (size_ > N) {
+            throw std::runtime_error("FrozenHashMap Overflow");
+        }
+        Build();
+    }
+
+    constexpr const V& operator[](const K& key) const {
+        size_t index = IndexOf(key);
+        if (index == kEmpty) {
+            throw std::runtime_error("FrozenHashMap: no such key");
+        }
+        return items_[index].second;
+    }
+
+    constexpr bool Find(const K& key) const {
+        return IndexOf(key) != kEmpty;
+    }
+
+    constexpr size_t Size() const {
+        return size_;
+    }
+};
+
+template <class K, class V, size_t N, class Hash>
+constexpr void FrozenHashMap<K, V, N, Hash>::Build() {
+    std::array<size_t, kTableSize> bucket_size{};
+    std::array<size_t, N> order{};
+    for (size_t i = 0; i < size_; ++i) {
+        ++bucket_size[BucketOf(items_[i].first)];
+        order[i] = i;
+    }
+    // Largest buckets first, while the table is still empty, each bucket's keys together
+    std::sort(order.begin(), order.begin() + size_, [&](size_t left, size_t right) {
+        size_t left_bucket = BucketOf(items_[left].first);
+        size_t right_bucket = BucketOf(items_[right].first);
+        if (bucket_size[left_bucket] != bucket_size[right_bucket]) {
+            return bucket_size[left_bucket] > bucket_size[right_bucket];
+        }
+        return left_bucket < right_bucket;
+    });
+    slots_.fill(kEmpty);
+    size_t free_slot = 0;
+    for (size_t begin = 0; begin < size_;) {
+        size_t bucket = BucketOf(items_[order[begin]].first);
+        size_t end = begin + bucket_size[bucket];
+        if (end - begin == 1) {
+            while (slots_[free_slot] != kEmpty) {
+                ++free_slot;
+            }
+            seeds_[bucket] = kDirectSlot | free_slot;
+            slots_[free_slot] = order[begin];
+            begin = end;
+            continue;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            for (size_t j = begin; j < i; ++j) {
+                if (items_[order[i]].first == items_[order[j]].first) {
+                    throw std::runtime_error("FrozenHashMap: duplicate key");
+                }
+            }
+        }
+        for (uint64_t seed = 1;; ++seed) {
+            if (seed == kMaxSeed) {
+                throw std::runtime_error("FrozenHashMap: no perfect hash");
+            }
+            bool fits = true;
+            for (size_t i = begin; i < end && fits; ++i) {
+                size_t slot = SlotOf(items_[order[i]].first, seed);
+                fits = slots_[slot] == kEmpty;
+                for (size_t j = begin; j < i && fits; ++j) {
+                    fits = SlotOf(items_[order[j]].first, seed) != slot;
+                }
+            }
+            if (fits) {
+                seeds_[bucket] = seed;
+                for (size_t i = begin; i < end; ++i) {
+                    slots_[SlotOf(items_[order[i]].first, seed)] = order[i];
+                }
+                break;
+            }
+        }
+        begin = end;
+    }
+}
+
+template <class K, class V, size_t N>
+constexpr auto MakeFrozenHashMap(const std::pair<K, V> (&items)[N]) {
+    std::array<std::pair<K, V>, N> data;
+    for (size_t i = 0; i < N; ++i) {
+        data[i] = items[i];
+    }
+    return FrozenHashMap<K, V, N>(data);
+}
+
+template <class K, class V, int S>
+constexpr auto MakeFrozenHashMap(const ConstexprMap<K, V, S>& map) {
+    std::array<std::pair<K, V>, S> data;
+    for (size_t i = 0; i < map.Size(); ++i) {
+        data[i] = map.GetByIndex(i);
+    }
+    return FrozenHashMap<K, V, S>(data, map.Size());
+}
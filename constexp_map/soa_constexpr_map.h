@@ -0,0 +1,201 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+template <size_t Width>
+struct SimdKeyTraits;
+
+template <>
+struct SimdKeyTraits<1> {
+    using Unsigned = uint8_t;
+};
+
+template <>
+struct SimdKeyTraits<2> {
+    using Unsigned = uint16_t;
+};
+
+template <>
+struct SimdKeyTraits<4> {
+    using Unsigned = uint32_t;
+};
+
+template <>
+struct SimdKeyTraits<8> {
+    using Unsigned = uint64_t;
+};
+
+template <class K>
+concept SimdKey = (std::is_integral_v<K> || std::is_enum_v<K>) &&
+                  (sizeof(K) == 1 || sizeof(K) == 2 || sizeof(K) == 4 || sizeof(K) == 8);
+
+// Index of the first `key` in `keys[0, size)`, or `size`. Compares a whole vector register of
+// keys at a time (AVX2 when enabled, SSE2 otherwise) and finishes the tail one by one.
+template <SimdKey K>
+size_t SimdFindKey(const K* keys, size_t size, K key) {
+    constexpr size_t kWidth = sizeof(K);
+    using Unsigned = typename SimdKeyTraits<kWidth>::Unsigned;
+    auto needle = std::bit_cast<Unsigned>(key);
+    size_t i = 0;
+#if defined(__AVX2__)
+    __m256i pattern;
+    if constexpr (kWidth == 1) {
+        pattern = _mm256_set1_epi8(static_cast<char>(needle));
+    } else if constexpr (kWidth == 2) {
+        pattern = _mm256_set1_epi16(static_cast<short>(needle));
+    } else if constexpr (kWidth == 4) {
+        pattern = _mm256_set1_epi32(static_cast<int>(needle));
+    } else {
+        pattern = _mm256_set1_epi64x(static_cast<long long>(needle));
+    }
+    for (; i + 32 / kWidth <= size; i += 32 / kWidth) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i equal;
+        if constexpr (kWidth == 1) {
+            equal = _mm256_cmpeq_epi8(block, pattern);
+        } else if constexpr (kWidth == 2) {
+            equal = _mm256_cmpeq_epi16(block, pattern);
+        } else if constexpr (kWidth == 4) {
+            equal = _mm256_cmpeq_epi32(block, pattern);
+        } else {
+            equal = _mm256_cmpeq_epi64(block, pattern);
+        }
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(equal));
+        if (mask != 0) {
+            return i + std::countr_zero(mask) / kWidth;
+        }
+    }
+#elif defined(__SSE2__)
+    __m128i pattern;
+    if constexpr (kWidth == 1) {
+        pattern = _mm_set1_epi8(static_cast<char>(needle));
+    } else if constexpr (kWidth == 2) {
+        pattern = _mm_set1_epi16(static_cast<short>(needle));
+    } else if constexpr (kWidth == 4) {
+        pattern = _mm_set1_epi32(static_cast<int>(needle));
+    } else {
+        pattern = _mm_set1_epi64x(static_cast<long long>(needle));
+    }
+    for (; i + 16 / kWidth <= size; i += 16 / kWidth) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+        __m128i equal;
+        if constexpr (kWidth == 1) {
+            equal = _mm_cmpeq_epi8(block, pattern);
+        } else if constexpr (kWidth == 2) {
+            equal = _mm_cmpeq_epi16(block, pattern);
+        } else if constexpr (kWidth == 4) {
+            equal = _mm_cmpeq_epi32(block, pattern);
+        } else {
+            // SSE2 has no 64-bit compare: both 32-bit halves have to match
+            equal = _mm_cmpeq_epi32(block, pattern);
+            equal = _mm_and_si128(equal, _mm_shuffle_epi32(equal, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(equal));
+        if (mask != 0) {
+            return i + std::countr_zero(mask) / kWidth;
+        }
+    }
+#endif
+    for (; i < size; ++i) {
+        if (keys[i] == key) {
+            return i;
+        }
+    }
+    return size;
+}
+
+// `ConstexprMap` with keys and values in separate arrays: a key scan reads only keys, packed
+// densely into cache lines. Integral and enum keys are compared with SIMD at runtime; constant
+// evaluation and other key types use a plain loop.
+template <class K, class V, int MaxSize = 8>
+class SoaConstexprMap {
+private:
+    std::array<K, MaxSize> keys_;
+    std::array<V, MaxSize> values_;
+    size_t size_ = 0;
+
+    constexpr size_t IndexOf(const K& key) const {
+        if constexpr (SimdKey<K>) {
+            if (!std::is_constant_evaluated()) {
+                return SimdFindKey(keys_.data(), size_, key);
+            }
+        }
+        for (size_t i = 0; i < size_; ++i) {
+            if (keys_[i] == key) {
+                return i;
+            }
+        }
+        return size_;
+    }
+
+public:
+    constexpr SoaConstexprMap() : keys_(), values_() {
+    }
+
+    constexpr V& operator[](const K& key) {
+        size_t index = IndexOf(key);
+        if (index != size_) {
+            return values_[index];
+        }
+        if (size_ == MaxSize) {
+            throw std::runtime_error("SoaConstexprMap Overflow");
+        }
+        keys_[size_] = key;
+        values_[size_] = V();
+        return values_[size_++];
+    }
+
+    constexpr const V& operator[](const K& key) const {
+        size_t index = IndexOf(key);
+        if (index == size_) {
+            throw std::runtime_error("SoaConstexprMap Overflow");
+        }
+        return values_[index];
+    }
+
+    constexpr bool Erase(const K& key) {
+        size_t index = IndexOf(key);
+        if (index == size_) {
+            return false;
+        }
+        for (size_t i = index; i + 1 < size_; ++i) {
+            keys_[i] = std::move(keys_[i + 1]);
+            values_[i] = std::move(values_[i + 1]);
+        }
+        --size_;
+        return true;
+    }
+
+    constexpr bool Find(const K& key) const {
+        return IndexOf(key) != size_;
+    }
+
+    constexpr size_t Size() const {
+        return size_;
+    }
+
+    constexpr std::pair<const K&, V&> GetByIndex(size_t pos) {
+        if (pos >= size_) {
+            throw std::runtime_error("SoaConstexprMap Overflow");
+        }
+        return {keys_[pos], values_[pos]};
+    }
+
+    constexpr std::pair<const K&, const V&> GetByIndex(size_t pos) const {
+        if (pos >= size_) {
+            throw std::runtime_error("SoaConstexprMap Overflow");
+        }
+        return {keys_[pos], values_[pos]};
+    }
+};
@@ -2,29 +2,58 @@
 
 #include <constexpr_map.h>
 
-#include <type_traits>
 #include <array>
 #include <algorithm>
+#include <functional>
 
-template<class K, class V, int S>
-constexpr auto Sort(ConstexprMap<K, V, S> map) {
-    ConstexprMap<K, V, S> res = map;
-    if constexpr (std::is_integral_v<K>) {
-        for (size_t i = 0; i < res.Size() - 1; ++i) {
-            for (size_t j = 0; j < res.Size() - 1; ++j) {
-                if (res.GetByIndex(j).first < res.GetByIndex(j + 1).first) {
-                    std::swap(res.GetByIndex(j), res.GetByIndex(j + 1));
+// Stable bottom-up merge sort of `data[0, size)`, usable in constant expressions
+template <class T, size_t N, class Compare>
+constexpr void MergeSort(std::array<T, N>& data, size_t size, Compare comp) {
+    std::array<T, N> buffer;
+    for (size_t width = 1; width < size; width *= 2) {
+        for (size_t left = 0; left < size; left += 2 * width) {
+            size_t mid = std::min(left + width, size);
+            size_t right = std::min(left + 2 * width, size);
+            size_t i = left;
+            size_t j = mid;
+            size_t k = left;
+            while (i < mid && j < right) {
+                if (comp(data[j], data[i])) {
+                    buffer[k++] = data[j++];
+                } else {
+                    buffer[k++] = data[i++];
                 }
             }
-        }
-    } else {
-        for (size_t i = 0; i < res.Size() - 1; ++i) {
-            for (size_t j = 0; j < res.Size() - 1; ++j) {
-                if (res.GetByIndex(j + 1).first < res.GetByIndex(j).first) {
-                    std::swap(res.GetByIndex(j), res.GetByIndex(j + 1));
-                }
+            while (i < mid) {
+                buffer[k++] = data[i++];
+            }
+            while (j < right) {
+                buffer[k++] = data[j++];
             }
         }
+        std::swap(data, buffer);
     }
-    return res;
+}
+
+// Orders the elements by key with `comp`
+template <class K, class V, int S, class Compare>
+constexpr auto Sort(ConstexprMap<K, V, S> map, Compare comp) {
+    std::array<std::pair<K, V>, S> items;
+    for (size_t i = 0; i < map.Size(); ++i) {
+        items[i] = map.GetByIndex(i);
+    }
+    using Item = std::pair<K, V>;
+    MergeSort(items, map.Size(), [&comp](const Item& left, const Item& right) {
+        return comp(left.first, right.first);
+    });
+    for (size_t i = 0; i < map.Size(); ++i) {
+        map.GetByIndex(i) = items[i];
+    }
+    return map;
+}
+
+// Ascending order of keys, whatever their type
+template <class K, class V, int S>
+constexpr auto Sort(ConstexprMap<K, V, S> map) {
+    return Sort(map, std::less<K>());
 }
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <constexpr_map.h>
+#include <sort.h>
+
+#include <array>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+
+// Read-only map with keys kept sorted by `Compare`: lookups are a binary search instead of the
+// linear scan of `ConstexprMap`.
+template <class K, class V, int MaxSize = 8, class Compare = std::less<K>>
+class SortedConstexprMap {
+private:
+    std::array<std::pair<K, V>, MaxSize> data_;
+    size_t size_ = 0;
+
+    // Index of the first element whose key is not less than `key`. The search narrows the
+    // range by halves without branching on the comparison result.
+    constexpr size_t LowerBound(const K& key) const {
+        size_t first = 0;
+        size_t length = size_;
+        while (length > 0) {
+            size_t half = length / 2;
+            first += Compare()(data_[first + half].first, key) ? length - half : 0;
+            length = half;
+        }
+        return first;
+    }
+
+    constexpr size_t IndexOf(const K& key) const {
+        size_t index = LowerBound(key);
+        if (index < size_ && !Compare()(key, data_[index].first)) {
+            return index;
+        }
+        return size_;
+    }
+
+    constexpr void SortData() {
+        MergeSort(data_, size_, [](const std::pair<K, V>& left, const std::pair<K, V>& right) {
+            return Compare()(left.first, right.first);
+        });
+    }
+
+public:
+    constexpr SortedConstexprMap() = default;
+
+    constexpr explicit SortedConstexprMap(const ConstexprMap<K, V, MaxSize>& map)
+        : size_(map.Size()) {
+        for (size_t i = 0; i < size_; ++i) {
+            data_[i] = map.GetByIndex(i);
+        }
+        SortData();
+    }
+
+    // From the first `size` pairs of `items`, which need no particular order. Large tables
+    // are cheaper to build this way: filling a `ConstexprMap` scans it once per key.
+    constexpr explicit SortedConstexprMap(const std::array<std::pair<K, V>, MaxSize>& items,
+                                          size_t size = MaxSize)
+        : data_(items), size_(size) {
+        if (size_ > static_cast<size_t>(MaxSize)) {
+            throw std::runtime_error("SortedConstexprMap Overflow");
+        }
+        SortData();
+    }
+
+    constexpr const V& operator[](const K& key) const {
+        size_t index = IndexOf(key);
+        if (index == size_) {
+            throw std::runtime_error("SortedConstexprMap: no such key");
+        }
+        return data_[index].second;
+    }
+
+    constexpr bool Find(const K& key) const {
+        return IndexOf(key) != size_;
+    }
+
+    constexpr size_t Size() const {
+        return size_;
+    }
+
+    constexpr const std::pair<K, V>& GetByIndex(size_t pos) const {
+        if (pos >= size_) {
+            throw std::runtime_error("SortedConstexprMap Overflow");
+        }
+        return data_[pos];
+    }
+};
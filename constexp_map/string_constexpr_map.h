@@ -0,0 +1,84 @@
+#pragma once
+
+#include <frozen_hash_map.h>
+#include <soa_constexpr_map.h>
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+// Read-only map from string keys, sized exactly for its contents. Every key is stored as a
+// `std::string_view` next to a hash computed at compile time; a lookup hashes the query once
+// and compares full keys only where the hashes match. The hashes are packed in their own
+// array and scanned with `SimdFindKey` at runtime.
+template <class V, size_t N>
+class StringConstexprMap {
+private:
+    std::array<uint64_t, N> hashes_;
+    std::array<std::string_view, N> keys_;
+    std::array<V, N> values_;
+
+    static constexpr uint64_t HashOf(std::string_view key) {
+        return FrozenHash<std::string_view>()(key, 0);
+    }
+
+    constexpr size_t FindHash(uint64_t hash, size_t from) const {
+        if (!std::is_constant_evaluated()) {
+            return from + SimdFindKey(hashes_.data() + from, N - from, hash);
+        }
+        while (from < N && hashes_[from] != hash) {
+            ++from;
+        }
+        return from;
+    }
+
+    constexpr size_t IndexOf(std::string_view key) const {
+        uint64_t hash = HashOf(key);
+        for (size_t i = FindHash(hash, 0); i < N; i = FindHash(hash, i + 1)) {
+            if (keys_[i] == key) {
+                return i;
+            }
+        }
+        return N;
+    }
+
+public:
+    constexpr explicit StringConstexprMap(const std::pair<std::string_view, V> (&items)[N])
+        : hashes_(), keys_(), values_() {
+        for (size_t i = 0; i < N; ++i) {
+            hashes_[i] = HashOf(items[i].first);
+            keys_[i] = items[i].first;
+            values_[i] = items[i].second;
+            for (size_t j = 0; j < i; ++j) {
+                if (hashes_[j] == hashes_[i] && keys_[j] == keys_[i]) {
+                    throw std::runtime_error("StringConstexprMap: duplicate key");
+                }
+            }
+        }
+    }
+
+    constexpr const V& operator[](std::string_view key) const {
+        size_t index = IndexOf(key);
+        if (index == N) {
+            throw std::runtime_error("StringConstexprMap: no such key");
+        }
+        return values_[index];
+    }
+
+    constexpr bool Find(std::string_view key) const {
+        return IndexOf(key) != N;
+    }
+
+    constexpr size_t Size() const {
+        return N;
+    }
+};
+
+// `MakeConstexprMap<int>({{"a", 1}, {"b", 2}})`: the size comes from the initializer list.
+// The value type has to be spelled out, it cannot be deduced through nested braces.
+template <class V, size_t N>
+constexpr auto MakeConstexprMap(const std::pair<std::string_view, V> (&items)[N]) {
+    return StringConstexprMap<V, N>(items);
+}
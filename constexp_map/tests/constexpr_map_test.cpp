@@ -0,0 +1,109 @@
+#include <constexpr_map.h>
+#include <dispatch.h>
+#include <frozen_hash_map.h>
+#include <sort.h>
+#include <sorted_constexpr_map.h>
+#include <string_constexpr_map.h>
+
+#include <gtest/gtest.h>
+
+#include <string_view>
+
+namespace {
+
+constexpr ConstexprMap<int, int, 16> MakeSquares() {
+    ConstexprMap<int, int, 16> map;
+    for (int key : {9, 3, 12, 1, 7, 5}) {
+        map[key] = key * key;
+    }
+    return map;
+}
+
+constexpr auto kSquares = MakeSquares();
+
+int Twice(int x) {
+    return 2 * x;
+}
+
+int Negate(int x) {
+    return -x;
+}
+
+constexpr ConstexprMap<int, int (*)(int), 4> MakeHandlers(int first, int second) {
+    ConstexprMap<int, int (*)(int), 4> map;
+    map[first] = &Twice;
+    map[second] = &Negate;
+    return map;
+}
+
+constexpr auto kDense = MakeHandlers(1, 2);
+constexpr auto kSparse = MakeHandlers(-1000, 1 << 20);
+
+}  // namespace
+
+TEST(ConstexprMap, InsertFindErase) {
+    static_assert(kSquares.Size() == 6 && kSquares[7] == 49 && !kSquares.Find(2));
+    ConstexprMap<int, int, 2> map;
+    map[1] = 10;
+    map[2] = 20;
+    EXPECT_THROW(map[3], std::runtime_error);
+    EXPECT_TRUE(map.Erase(1));
+    EXPECT_FALSE(map.Find(1));
+    EXPECT_EQ(map[2], 20);
+}
+
+TEST(Sort, DefaultsToAscendingKeys) {
+    constexpr auto sorted = Sort(kSquares);
+    for (size_t i = 1; i < sorted.Size(); ++i) {
+        EXPECT_LT(sorted.GetByIndex(i - 1).first, sorted.GetByIndex(i).first);
+    }
+    constexpr auto descending = Sort(kSquares, std::greater<int>());
+    static_assert(descending.GetByIndex(0).first == 12);
+}
+
+TEST(SortedConstexprMap, BinarySearchMatchesLinearScan) {
+    constexpr SortedConstexprMap<int, int, 16> sorted(kSquares);
+    for (int key = 0; key < 14; ++key) {
+        EXPECT_EQ(sorted.Find(key), kSquares.Find(key)) << key;
+        if (sorted.Find(key)) {
+            EXPECT_EQ(sorted[key], kSquares[key]);
+        }
+    }
+}
+
+TEST(SortedConstexprMap, BuiltFromAnArray) {
+    constexpr std::array<std::pair<int, int>, 6> kItems = {
+        {{5, 50}, {1, 10}, {4, 40}, {2, 20}, {9, 90}, {0, 0}}};
+    constexpr SortedConstexprMap<int, int, 6> sorted(kItems, 5);
+    static_assert(sorted.Size() == 5);
+    static_assert(sorted.GetByIndex(0).first == 1);
+    static_assert(sorted.GetByIndex(4).first == 9);
+    EXPECT_EQ(sorted[4], 40);
+    EXPECT_FALSE(sorted.Find(0));
+    EXPECT_THROW((SortedConstexprMap<int, int, 6>(kItems, 7)), std::runtime_error);
+}
+
+TEST(FrozenHashMap, PerfectHashLookups) {
+    constexpr auto frozen = MakeFrozenHashMap(kSquares);
+    static_assert(frozen[12] == 144);
+    for (int key = 0; key < 14; ++key) {
+        EXPECT_EQ(frozen.Find(key), kSquares.Find(key)) << key;
+    }
+}
+
+TEST(StringConstexprMap, LooksUpByHashThenKey) {
+    constexpr auto map = MakeConstexprMap<int>({{"get", 1}, {"put", 2}, {"delete", 3}});
+    static_assert(map.Size() == 3 && map["put"] == 2);
+    EXPECT_EQ(map[std::string_view("delete")], 3);
+    EXPECT_FALSE(map.Find("post"));
+}
+
+TEST(Dispatch, DenseAndSparseKeys) {
+    auto fallback = [](int, int x) { return x + 1000; };
+    EXPECT_EQ(Dispatch<kDense>(1, fallback, 5), 10);
+    EXPECT_EQ(Dispatch<kDense>(2, fallback, 5), -5);
+    EXPECT_EQ(Dispatch<kDense>(3, fallback, 5), 1005);
+    EXPECT_EQ(Dispatch<kSparse>(-1000, fallback, 5), 10);
+    EXPECT_EQ(Dispatch<kSparse>(1 << 20, fallback, 5), -5);
+    EXPECT_EQ(Dispatch<kSparse>(0, fallback, 5), 1005);
+}
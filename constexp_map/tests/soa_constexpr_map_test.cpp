@@ -0,0 +1,146 @@
+#include <soa_constexpr_map.h>
+
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Compiled twice: into constexp_map_tests with the default SSE2 path and, on hosts with AVX2,
+// into constexp_map_avx2_tests with -mavx2
+
+namespace {
+
+enum class Small : uint8_t {};
+enum class Wide : int64_t {};
+
+template <class K>
+class SimdFindKeyTest : public testing::Test {
+protected:
+    // Distinct keys with every byte in play, including negative values for signed types
+    static std::vector<K> Keys(size_t size) {
+        std::vector<K> keys;
+        for (size_t i = 0; i < size; ++i) {
+            auto bits = static_cast<uint64_t>(i * 0x9E3779B97F4A7C15ull + 0x0123456789ABCDEFull);
+            if constexpr (sizeof(K) < sizeof(uint64_t)) {
+                // Keeps the low byte distinct, so narrow keys do not collide
+                bits = (bits & ~uint64_t(0xFF)) | (i & 0xFF);
+            }
+            keys.push_back(static_cast<K>(bits));
+        }
+        return keys;
+    }
+};
+
+using KeyTypes = testing::Types<int8_t, uint8_t, Small, int16_t, uint16_t, int32_t, uint32_t,
+                                int64_t, uint64_t, Wide>;
+TYPED_TEST_SUITE(SimdFindKeyTest, KeyTypes);
+
+}  // namespace
+
+// Every position of every size up to a few vector registers plus a tail
+TYPED_TEST(SimdFindKeyTest, FindsEveryPosition) {
+    for (size_t size = 0; size <= 70; ++size) {
+        std::vector<TypeParam> keys = this->Keys(size);
+        for (size_t at = 0; at < size; ++at) {
+            ASSERT_EQ(SimdFindKey(keys.data(), size, keys[at]), at) << "size " << size;
+        }
+    }
+}
+
+TYPED_TEST(SimdFindKeyTest, MissReturnsSize) {
+    std::vector<TypeParam> keys = this->Keys(71);
+    TypeParam missing = keys.back();
+    for (size_t size = 0; size + 1 < keys.size(); ++size) {
+        ASSERT_EQ(SimdFindKey(keys.data(), size, missing), size);
+    }
+}
+
+TYPED_TEST(SimdFindKeyTest, FirstOfDuplicates) {
+    std::vector<TypeParam> keys = this->Keys(64);
+    keys[40] = keys[17];
+    keys[63] = keys[17];
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), keys[17]), 17u);
+}
+
+// Does not look past `size`, even when the key sits right behind it
+TYPED_TEST(SimdFindKeyTest, StopsAtSize) {
+    std::vector<TypeParam> keys = this->Keys(64);
+    for (size_t size = 0; size < keys.size(); ++size) {
+        ASSERT_EQ(SimdFindKey(keys.data(), size, keys[size]), size);
+    }
+}
+
+// Neighbours that differ from the key in a single byte, so a compare of the wrong lane width
+// reports a match where there is none
+TYPED_TEST(SimdFindKeyTest, KeysDifferingInOneByte) {
+    using Unsigned = typename SimdKeyTraits<sizeof(TypeParam)>::Unsigned;
+    const auto needle = static_cast<Unsigned>(0x8877665544332211ull);
+    std::vector<TypeParam> keys;
+    for (size_t i = 0; i < 70; ++i) {
+        auto flipped = static_cast<Unsigned>(Unsigned(0x80) << (8 * (i % sizeof(TypeParam))));
+        keys.push_back(std::bit_cast<TypeParam>(static_cast<Unsigned>(needle ^ flipped)));
+    }
+    const auto key = std::bit_cast<TypeParam>(needle);
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), key), keys.size());
+    for (size_t at = 0; at < keys.size(); ++at) {
+        std::vector<TypeParam> with_key = keys;
+        with_key[at] = key;
+        ASSERT_EQ(SimdFindKey(with_key.data(), with_key.size(), key), at);
+    }
+}
+
+// Without a 64-bit compare in SSE2 the halves are compared separately; a key matching only one
+// of them must not count
+TEST(SimdFindKey, EightByteKeysNeedBothHalves) {
+    std::vector<uint64_t> keys(32);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = (uint64_t(i + 1) << 32) | 7;
+    }
+    keys[5] = 0xFFFFFFFF00000000ull | 9;
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), uint64_t(7)), keys.size());
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), (uint64_t(1) << 32) | 9), keys.size());
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), (uint64_t(20) << 32) | 7), 19u);
+    EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), keys[5]), 5u);
+}
+
+TEST(SimdFindKey, ExtremeValues) {
+    std::vector<int64_t> keys = {std::numeric_limits<int64_t>::max(), 0, -1,
+                                 std::numeric_limits<int64_t>::min()};
+    for (size_t i = 0; i < keys.size(); ++i) {
+        EXPECT_EQ(SimdFindKey(keys.data(), keys.size(), keys[i]), i);
+    }
+    std::vector<int8_t> bytes(40, -1);
+    bytes[33] = std::numeric_limits<int8_t>::min();
+    EXPECT_EQ(SimdFindKey(bytes.data(), bytes.size(), std::numeric_limits<int8_t>::min()), 33u);
+}
+
+TEST(SoaConstexprMap, FindsEveryKey) {
+    SoaConstexprMap<int, int, 64> map;
+    for (int key = 0; key < 64; ++key) {
+        map[key * 3] = key;
+    }
+    for (int key = 0; key < 64; ++key) {
+        EXPECT_EQ(map[key * 3], key);
+        EXPECT_FALSE(map.Find(key * 3 + 1));
+    }
+    EXPECT_TRUE(map.Erase(0));
+    EXPECT_EQ(map.Size(), 63u);
+}
+
+TEST(SoaConstexprMap, ConstantAndRuntimeLookupsAgree) {
+    constexpr auto map = [] {
+        SoaConstexprMap<uint16_t, int, 40> map;
+        for (int i = 0; i < 40; ++i) {
+            map[static_cast<uint16_t>(i * 1000)] = i;
+        }
+        return map;
+    }();
+    static_assert(map[static_cast<uint16_t>(39000)] == 39);
+    static_assert(!map.Find(1));
+    for (int i = 0; i < 40; ++i) {
+        EXPECT_EQ(map[static_cast<uint16_t>(i * 1000)], i);
+    }
+    EXPECT_FALSE(map.Find(1));
+}
@@ -0,0 +1,174 @@
+#include <benchmark.h>
+#include <cow_vector.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kElements = 4096;
+
+template <typename T>
+COWVector<T> Filled(size_t size) {
+    COWVector<T> vector;
+    vector.Reserve(size);
+    for (size_t i = 0; i < size; ++i) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            vector.PushBack(std::to_string(i));
+        } else {
+            vector.PushBack(static_cast<T>(i));
+        }
+    }
+    return vector;
+}
+
+}  // namespace
+
+BENCHMARK(COWVectorPushBackInt) {
+    COWVector<int> vector;
+    for (size_t i = 0; i < iterations; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    DoNotOptimize(vector.Size());
+}
+
+BENCHMARK(StdVectorPushBackInt) {
+    std::vector<int> vector;
+    for (size_t i = 0; i < iterations; ++i) {
+        vector.push_back(static_cast<int>(i));
+    }
+    DoNotOptimize(vector.size());
+}
+
+BENCHMARK(COWVectorCopy) {
+    COWVector<std::string> vector = Filled<std::string>(kElements);
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<std::string> copy = vector;
+        DoNotOptimize(copy.Size());
+    }
+}
+
+BENCHMARK(StdVectorCopy) {
+    std::vector<std::string> vector(kElements, "element");
+    for (size_t i = 0; i < iterations; ++i) {
+        std::vector<std::string> copy = vector;
+        DoNotOptimize(copy.size());
+    }
+}
+
+// Snapshot, then one write: clones the chunk table and one chunk
+BENCHMARK(COWVectorSnapshotThenSet) {
+    COWVector<std::string> vector = Filled<std::string>(kElements);
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<std::string> snapshot = vector;
+        vector.Set(i % kElements, "written");
+        DoNotOptimize(snapshot.Size());
+    }
+}
+
+// The same without copy-on-write: a snapshot copies every string
+BENCHMARK(StdVectorCopyThenSet) {
+    std::vector<std::string> vector(kElements, "element");
+    for (size_t i = 0; i < iterations; ++i) {
+        std::vector<std::string> snapshot = vector;
+        vector[i % kElements] = "written";
+        DoNotOptimize(snapshot.size());
+    }
+}
+
+BENCHMARK(COWVectorSetUnshared) {
+    COWVector<std::string> vector = Filled<std::string>(kElements);
+    for (size_t i = 0; i < iterations; ++i) {
+        vector.Set(i % kElements, "written");
+    }
+}
+
+BENCHMARK(COWVectorGet) {
+    COWVector<int> vector = Filled<int>(kElements);
+    int64_t sum = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        sum += vector.Get(i % kElements);
+    }
+    DoNotOptimize(sum);
+}
+
+BENCHMARK(COWVectorDiffOneChunk) {
+    COWVector<int> from = Filled<int>(kElements);
+    COWVector<int> to = from;
+    to.Set(kElements / 2, -1);
+    for (size_t i = 0; i < iterations; ++i) {
+        auto ranges = COWVector<int>::Diff(from, to);
+        DoNotOptimize(ranges.size());
+    }
+}
+
+// A consumer that mirrors the vector and is woken after every round of a few writes. The
+// incremental one asks `Diff` what changed since the snapshot it saw last; the time is per
+// round.
+constexpr size_t kMirrored = 64 * 1024;
+constexpr size_t kWritesPerRound = 4;
+
+template <class Consume>
+void ConsumeRounds(size_t iterations, Consume consume) {
+    COWVector<int> vector = Filled<int>(kMirrored);
+    COWVector<int> seen = vector;
+    std::vector<int> mirror(kMirrored);
+    for (size_t i = 0; i < iterations; ++i) {
+        for (size_t write = 0; write < kWritesPerRound; ++write) {
+            vector.Set((i * 7919 + write * 104729) % kMirrored, static_cast<int>(i));
+        }
+        consume(seen, vector, mirror);
+        seen = vector;
+    }
+    DoNotOptimize(mirror.data());
+}
+
+BENCHMARK(COWVectorConsumeDiff) {
+    ConsumeRounds(iterations, [](const COWVector<int>& seen, const COWVector<int>& current,
+                                 std::vector<int>& mirror) {
+        if (seen.Version() == current.Version()) {
+            return;
+        }
+        for (auto range : COWVector<int>::Diff(seen, current)) {
+            for (size_t at = range.begin; at < range.end; ++at) {
+                mirror[at] = current.Get(at);
+            }
+        }
+    });
+}
+
+BENCHMARK(COWVectorConsumeRescan) {
+    ConsumeRounds(iterations, [](const COWVector<int>&, const COWVector<int>& current,
+                                 std::vector<int>& mirror) {
+        for (size_t at = 0; at < current.Size(); ++at) {
+            mirror[at] = current.Get(at);
+        }
+    });
+}
+
+// 1k edits spread over the vector after a snapshot, as one batch; the time is per batch
+constexpr size_t kEdits = 1000;
+
+BENCHMARK(COWVectorMutateBatch) {
+    COWVector<int> vector = Filled<int>(kElements);
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<int> snapshot = vector;
+        vector.Mutate([i](auto& view) {
+            for (size_t edit = 0; edit < kEdits; ++edit) {
+                view[(edit * 997 + i) % kElements] = static_cast<int>(edit);
+            }
+        });
+        DoNotOptimize(snapshot.Size());
+    }
+}
+
+BENCHMARK(COWVectorSetBatch) {
+    COWVector<int> vector = Filled<int>(kElements);
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<int> snapshot = vector;
+        for (size_t edit = 0; edit < kEdits; ++edit) {
+            vector.Set((edit * 997 + i) % kElements, static_cast<int>(edit));
+        }
+        DoNotOptimize(snapshot.Size());
+    }
+}
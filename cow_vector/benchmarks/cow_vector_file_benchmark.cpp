@@ -0,0 +1,123 @@
+#include <benchmark.h>
+#include <cow_vector.h>
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kElements = 100000;
+
+// Written once per process, before any benchmark runs, and removed at exit
+struct SnapshotFile {
+    std::string path = "/tmp/cow_vector_file_benchmark." + std::to_string(getpid());
+
+    SnapshotFile() {
+        COWVector<std::string> vector;
+        vector.Reserve(kElements);
+        for (size_t i = 0; i < kElements; ++i) {
+            vector.PushBack("element " + std::to_string(i) + std::string(24, 'x'));
+        }
+        vector.Save(path);
+    }
+
+    ~SnapshotFile() {
+        std::remove(path.c_str());
+    }
+};
+
+const SnapshotFile kSnapshot;
+
+size_t ResidentKiB() {
+    size_t pages = 0;
+    size_t resident = 0;
+    if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+        if (std::fscanf(statm, "%zu %zu", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        std::fclose(statm);
+    }
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+// What a process without `MapFile` does at startup: reads the whole file and builds every
+// string
+std::vector<std::string> Deserialize(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    uint64_t count;
+    std::memcpy(&count, bytes.data() + sizeof(MappedFile::kMagic), sizeof(count));
+    const char* offsets = bytes.data() + sizeof(MappedFile::kMagic) + sizeof(count);
+    const char* blob = bytes.data() + MappedFile::HeaderSize(count);
+    std::vector<std::string> values;
+    values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t range[2];
+        std::memcpy(range, offsets + i * sizeof(uint64_t), sizeof(range));
+        values.emplace_back(blob + range[0], range[1] - range[0]);
+    }
+    return values;
+}
+
+// Loads the snapshot `iterations` times and reads from it; `rss_kib` is what one loaded copy
+// keeps resident, measured as the drop when the last one is released. `malloc_trim` hands the
+// freed heap pages back, otherwise the drop would be invisible for the deserialized vector.
+template <class Load, class Read>
+void Startup(size_t iterations, Load load, Read read) {
+    for (size_t i = 0; i + 1 < iterations; ++i) {
+        auto loaded = load(kSnapshot.path);
+        DoNotOptimize(read(loaded));
+    }
+    size_t resident;
+    {
+        auto loaded = load(kSnapshot.path);
+        DoNotOptimize(read(loaded));
+        resident = ResidentKiB();
+    }
+    malloc_trim(0);
+    size_t released = ResidentKiB();
+    SetBenchmarkCounter("rss_kib", resident > released ? resident - released : 0);
+}
+
+auto MapFile(const std::string& path) {
+    return COWVector<std::string>::MapFile(path);
+}
+
+size_t ReadOne(const COWVector<std::string>& vector) {
+    return vector.View(kElements / 2).size();
+}
+
+size_t ReadOne(const std::vector<std::string>& vector) {
+    return vector[kElements / 2].size();
+}
+
+size_t ReadAll(const COWVector<std::string>& vector) {
+    size_t total = 0;
+    for (size_t i = 0; i < vector.Size(); ++i) {
+        total += static_cast<unsigned char>(vector.View(i).back());
+    }
+    return total;
+}
+
+}  // namespace
+
+// Startup that reads a single element
+BENCHMARK(COWVectorMapFileStartup) {
+    Startup(iterations, MapFile, [](const auto& vector) { return ReadOne(vector); });
+}
+
+BENCHMARK(StdVectorDeserializeStartup) {
+    Startup(iterations, Deserialize, [](const auto& vector) { return ReadOne(vector); });
+}
+
+// Startup followed by a read of every element, the worst case for the mapping
+BENCHMARK(COWVectorMapFileScan) {
+    Startup(iterations, MapFile, [](const auto& vector) { return ReadAll(vector); });
+}
@@ -0,0 +1,94 @@
+#include <benchmark.h>
+#include <cow_vector.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kElements = 4096;
+
+struct Record {
+    int64_t id;
+    int64_t value;
+    int64_t check;
+};
+
+// Writer throughput while `readers` threads keep taking snapshots and scanning them: one
+// operation is a write, every 16th write publishes a snapshot
+void PublishWithReaders(size_t iterations, int readers) {
+    COWVector<Record> local;
+    for (size_t i = 0; i < kElements; ++i) {
+        local.PushBack({static_cast<int64_t>(i), 0, 0});
+    }
+    std::mutex mutex;
+    COWVector<Record> published = local;
+    std::atomic<bool> done = false;
+    std::vector<std::thread> threads;
+    for (int r = 0; r < readers; ++r) {
+        threads.emplace_back([&] {
+            int64_t sum = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                COWVector<Record> snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    snapshot = published;
+                }
+                for (size_t i = 0; i < snapshot.Size(); i += COWVector<Record>::kChunkSize) {
+                    sum += snapshot.Get(i).value;
+                }
+            }
+            DoNotOptimize(sum);
+        });
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t at = (i * 7919) % kElements;
+        local.Set(at, Record{static_cast<int64_t>(at), static_cast<int64_t>(i), 0});
+        if (i % 16 == 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            published = local;
+        }
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+[[maybe_unused]] const bool kPublishRegistered = [] {
+    for (int readers : {0, 1, 2, 4}) {
+        RegisterBenchmark("COWVectorPublish/readers:" + std::to_string(readers),
+                          [readers](size_t iterations) {
+                              PublishWithReaders(iterations, readers);
+                          });
+    }
+    return true;
+}();
+
+// Snapshot, then a write into a shared chunk: the chunk is cloned with memcpy for records and
+// element by element for strings
+template <typename T>
+void CloneChunk(size_t iterations, const T& value) {
+    COWVector<T> vector;
+    for (size_t i = 0; i < kElements; ++i) {
+        vector.PushBack(value);
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<T> snapshot = vector;
+        vector.Set((i * 64) % kElements, value);
+        DoNotOptimize(snapshot.Size());
+    }
+}
+
+}  // namespace
+
+BENCHMARK(COWVectorCloneChunkRecord) {
+    CloneChunk(iterations, Record{1, 2, 3});
+}
+
+BENCHMARK(COWVectorCloneChunkString) {
+    CloneChunk(iterations, std::string("short"));
+}
@@ -1,23 +1,134 @@
 #pragma once
 
-#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <instrumentation.h>
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <iterator>
+#include <mutex>
+#include <new>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Read-only mapping of a file written by `COWVector::Save`:
+//
+//     char magic[8] = "COWVEC01"
+//     uint64_t count
+//     uint64_t offsets[count + 1]    // into `blob`
+//     char blob[]
+class MappedFile {
+public:
+    static constexpr char kMagic[8] = {'C', 'O', 'W', 'V', 'E', 'C', '0', '1'};
+
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            throw std::runtime_error("MappedFile: cannot open " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(HeaderSize(0))) {
+            close(fd);
+            throw std::runtime_error("MappedFile: bad snapshot " + path);
+        }
+        length_ = st.st_size;
+        data_ = mmap(nullptr, length_, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (data_ == MAP_FAILED) {
+            throw std::runtime_error("MappedFile: cannot map " + path);
+        }
+        const char* bytes = static_cast<const char*>(data_);
+        std::memcpy(&count_, bytes + sizeof(kMagic), sizeof(count_));
+        offsets_ = reinterpret_cast<const uint64_t*>(bytes + sizeof(kMagic) + sizeof(count_));
+        blob_ = bytes + HeaderSize(count_);
+        if (std::memcmp(bytes, kMagic, sizeof(kMagic)) != 0 || count_ > length_ ||
+            HeaderSize(count_) > length_ || !ValidOffsets(length_ - HeaderSize(count_))) {
+            munmap(data_, length_);
+            throw std::runtime_error("MappedFile: bad snapshot " + path);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+        munmap(data_, length_);
+    }
 
-struct State {
-    int ref_count_;
-    std::vector<std::string> storage_;
+    static size_t HeaderSize(size_t count) {
+        return sizeof(kMagic) + sizeof(uint64_t) + (count + 1) * sizeof(uint64_t);
+    }
+
+    size_t Size() const {
+        return count_;
+    }
+
+    std::string_view Get(size_t at) const {
+        return std::string_view(blob_ + offsets_[at], offsets_[at + 1] - offsets_[at]);
+    }
+
+    // A mapped vector is copied into owned chunks at most once; the flag and the mutex make
+    // that safe when several snapshots sharing the state touch it from different threads.
+    std::atomic<bool> materialized_ = false;
+    std::mutex mutex_;
 
-    // rule of 5
-    State();
-    State(const State& other);
-    State(State&& other) = delete;
-    State& operator=(const State& other) = delete;
-    State& operator=(State&& other) = delete;
+private:
+    void* data_;
+    size_t length_;
+    uint64_t count_;
+    const uint64_t* offsets_;
+    const char* blob_;
+
+    // `Get` trusts the offsets, so every one of them is checked once here: they must not
+    // decrease and must stay within the blob
+    bool ValidOffsets(size_t blob_size) const {
+        uint64_t previous = 0;
+        for (size_t i = 0; i <= count_; ++i) {
+            if (offsets_[i] < previous || offsets_[i] > blob_size) {
+                return false;
+            }
+            previous = offsets_[i];
+        }
+        return true;
+    }
 };
 
+// Vector with copy-on-write semantics. Copies share one state in O(1). Elements live in
+// fixed-size chunks that are shared between states, so a write copies only the chunk table
+// and the chunk it lands in.
+//
+// Reference counts are atomic: a copy may be handed to another thread and read there while
+// the original is being written, as long as every handle has at most one writer.
+template <typename T = std::string, typename Alloc = std::allocator<T>>
 class COWVector {
 public:
-    COWVector();
+    static constexpr size_t kChunkSize = 64;
+
+    class MutableView;
+
+    // Half-open range of indices `[begin, end)`
+    struct IndexRange {
+        size_t begin;
+        size_t end;
+
+        bool operator==(const IndexRange&) const = default;
+    };
+
+    explicit COWVector(const Alloc& alloc = Alloc());
     ~COWVector();
 
     COWVector(const COWVector& other);
@@ -27,83 +138,678 @@ public:
 
     void Resize(size_t size);
 
-    const std::string& Get(size_t at) const;
-    const std::string& Back() const;
+    // Detaches from other copies and makes room for `size` elements in the chunk table. No
+    // element changes, so the version stays.
+    void Reserve(size_t size);
+
+    const T& Get(size_t at) const;
+    const T& Back() const;
+
+    void PushBack(const T& value);
+    void PushBack(T&& value);
+
+    // Builds the element in place, e.g. `EmplaceBack(std::string_view)` without a temporary
+    template <typename... Args>
+    void EmplaceBack(Args&&... args);
+
+    void Set(size_t at, const T& value);
+    void Set(size_t at, T&& value);
+
+    // Assigns from anything `T` accepts, e.g. a `std::string_view` into the existing string
+    template <typename U>
+        requires(!std::is_same_v<std::remove_cvref_t<U>, T> && std::is_assignable_v<T&, U &&>)
+    void Set(size_t at, U&& value) {
+        CopyState(state_->size_);
+        CopyChunk(at / kChunkSize)->Data()[at % kChunkSize] = std::forward<U>(value);
+    }
+
+    // Identifies the contents: copies share a version, every write gives a new one
+    uint64_t Version() const;
+
+    // Indices whose values differ between `from` and `to`, merged into ascending ranges;
+    // a size change shows up as the tail range. Every chunk pair is compared by pointer, so
+    // the walk is O(size / kChunkSize); elements are compared only in chunks that are not
+    // shared, i.e. those written since `from`.
+    static std::vector<IndexRange> Diff(const COWVector& from, const COWVector& to);
+
+    // Snapshot persistence for string-like elements. `MapFile` serves `View` straight from the
+    // mapped file without allocating; elements are copied into owned storage only on the first
+    // write or the first `Get`, which has to return a reference to a real `T`.
+    void Save(const std::string& path) const
+        requires std::is_convertible_v<const T&, std::string_view>;
 
-    void PushBack(const std::string& value);
+    static COWVector MapFile(const std::string& path, const Alloc& alloc = Alloc())
+        requires std::is_constructible_v<T, std::string_view>;
 
-    void Set(size_t at, const std::string& value);
+    std::string_view View(size_t at) const
+        requires std::is_convertible_v<const T&, std::string_view>;
+
+    // Batch of edits: detaches from other copies once and passes a `MutableView` to `func`.
+    // Returns whatever `func` returns.
+    template <typename F>
+    decltype(auto) Mutate(F&& func) {
+        CopyState(state_->size_);
+        MutableView view(this);
+        return std::forward<F>(func)(view);
+    }
 
 private:
-    void CopyState();
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    struct Chunk {
+        std::atomic<int> ref_count_;
+        size_t size_;
+        alignas(T) unsigned char storage_[kChunkSize * sizeof(T)];
+
+        Chunk() : ref_count_(1), size_(0) {
+        }
+
+        T* Data() {
+            return std::launder(reinterpret_cast<T*>(storage_));
+        }
+    };
+
+    using ChunkAlloc = typename AllocTraits::template rebind_alloc<Chunk>;
+    using ChunkTable = std::vector<Chunk*, typename AllocTraits::template rebind_alloc<Chunk*>>;
+
+    struct State {
+        std::atomic<int> ref_count_;
+        size_t size_;
+        uint64_t version_;
+        ChunkTable chunks_;
+        [[no_unique_address]] Alloc alloc_;
+        // Set for states loaded by `MapFile`; the chunks are empty until materialized
+        MappedFile* mapped_ = nullptr;
+
+        explicit State(const Alloc& alloc)
+            : ref_count_(1),
+              size_(0),
+              version_(NextVersion()),
+              chunks_(typename ChunkTable::allocator_type(alloc)),
+              alloc_(alloc) {
+        }
+
+        ~State() {
+            delete mapped_;
+        }
+    };
+
+    using StateAlloc = typename AllocTraits::template rebind_alloc<State>;
+
+    static State* NewState(const Alloc& alloc);
+    static State* CloneState(State* state, size_t capacity);
+    static void ReleaseState(State* state);
+
+    static Chunk* NewChunk(Alloc& alloc);
+    static Chunk* CloneChunk(Alloc& alloc, Chunk* chunk);
+    static void ReleaseChunk(Alloc& alloc, Chunk* chunk);
+    static void ShrinkChunk(Alloc& alloc, Chunk* chunk, size_t size);
+
+    static uint64_t NextVersion() {
+        static std::atomic<uint64_t> last_version = 0;
+        return last_version.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+
+    static bool IsMapped(const State* state) {
+        return state->mapped_ != nullptr &&
+               !state->mapped_->materialized_.load(std::memory_order_acquire);
+    }
+
+    static void Materialize(State* state);
+
+    explicit COWVector(State* state) : state_(state) {
+    }
+
+    // Makes `state_` owned by this vector alone with room for `capacity` elements. A content
+    // change starts a new version; `Reserve` passes `new_version = false` and keeps it.
+    void CopyState(size_t capacity, bool new_version = true);
+    Chunk* CopyChunk(size_t index);
+
     State* state_;
 };
 
-// State
+// Write access handed out by `COWVector::Mutate`. Chunks still shared with other copies are
+// copied the first time they are written through the view; each chunk is contiguous, so bulk
+// work can go chunk by chunk, and different chunks may be processed from different threads.
+// Valid only inside the `Mutate` call.
+template <typename T, typename Alloc>
+class COWVector<T, Alloc>::MutableView {
+public:
+    class Iterator;
+
+    size_t Size() const {
+        return vector_->Size();
+    }
+
+    const T& Get(size_t at) const {
+        return vector_->Get(at);
+    }
+
+    T& operator[](size_t at) {
+        return vector_->CopyChunk(at / kChunkSize)->Data()[at % kChunkSize];
+    }
+
+    size_t ChunkCount() const {
+        return vector_->state_->chunks_.size();
+    }
+
+    // Elements `[index * kChunkSize, ...)` as one contiguous span
+    std::span<T> ChunkSpan(size_t index) {
+        Chunk* chunk = vector_->CopyChunk(index);
+        return std::span<T>(chunk->Data(), chunk->size_);
+    }
+
+    template <typename F>
+    void ForEachChunk(F&& func) {
+        for (size_t i = 0; i < ChunkCount(); ++i) {
+            func(ChunkSpan(i));
+        }
+    }
+
+    // Random access over all elements, e.g. for `std::sort(view.begin(), view.end())`
+    Iterator begin() {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() {
+        return Iterator(this, Size());
+    }
+
+private:
+    friend class COWVector;
+
+    explicit MutableView(COWVector* vector) : vector_(vector) {
+    }
+
+    COWVector* vector_;
+};
+
+template <typename T, typename Alloc>
+class COWVector<T, Alloc>::MutableView::Iterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    Iterator() : view_(nullptr), at_(0) {
+    }
+
+    Iterator(MutableView* view, size_t at) : view_(view), at_(at) {
+    }
+
+    T& operator*() const {
+        return (*view_)[at_];
+    }
+
+    T* operator->() const {
+        return &(*view_)[at_];
+    }
+
+    T& operator[](ptrdiff_t offset) const {
+        return (*view_)[at_ + offset];
+    }
+
+    Iterator& operator++() {
+        ++at_;
+        return *this;
+    }
+
+    Iterator operator++(int) {
+        Iterator ret = *this;
+        ++at_;
+        return ret;
+    }
+
+    Iterator& operator--() {
+        --at_;
+        return *this;
+    }
+
+    Iterator operator--(int) {
+        Iterator ret = *this;
+        --at_;
+        return ret;
+    }
+
+    Iterator& operator+=(ptrdiff_t offset) {
+        at_ += offset;
+        return *this;
+    }
+
+    Iterator& operator-=(ptrdiff_t offset) {
+        at_ -= offset;
+        return *this;
+    }
+
+    friend Iterator operator+(Iterator it, ptrdiff_t offset) {
+        return it += offset;
+    }
+
+    friend Iterator operator+(ptrdiff_t offset, Iterator it) {
+        return it += offset;
+    }
+
+    friend Iterator operator-(Iterator it, ptrdiff_t offset) {
+        return it -= offset;
+    }
+
+    friend ptrdiff_t operator-(const Iterator& left, const Iterator& right) {
+        return static_cast<ptrdiff_t>(left.at_) - static_cast<ptrdiff_t>(right.at_);
+    }
+
+    friend bool operator==(const Iterator& left, const Iterator& right) {
+        return left.at_ == right.at_;
+    }
+
+    friend auto operator<=>(const Iterator& left, const Iterator& right) {
+        return left.at_ <=> right.at_;
+    }
+
+private:
+    MutableView* view_;
+    size_t at_;
+};
+
+// State and chunk management
 
-State::State() : ref_count_(1), storage_() {
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::NewState(const Alloc& alloc) -> State* {
+    StateAlloc state_alloc(alloc);
+    State* state = std::allocator_traits<StateAlloc>::allocate(state_alloc, 1);
+    INSTRUMENT_ALLOCATION(COW_VECTOR_STATE, sizeof(State));
+    return new (state) State(alloc);
 }
 
-State::State(const State& other) : ref_count_(1), storage_(other.storage_) {
+// Copies only the chunk table, the chunks themselves become shared. The table is sized for
+// `capacity` elements up front, so the write that triggered the copy does not grow it again.
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::CloneState(State* state, size_t capacity) -> State* {
+    State* copy = NewState(state->alloc_);
+    INSTRUMENT_COPY_ON_WRITE(COW_VECTOR_STATE);
+    INSTRUMENT(COW_VECTOR_CHUNK, REF_COUNT_OPS, state->chunks_.size());
+    copy->size_ = state->size_;
+    size_t chunk_capacity = (capacity + kChunkSize - 1) / kChunkSize;
+    copy->chunks_.reserve(std::max(state->chunks_.size(), chunk_capacity));
+    copy->chunks_.assign(state->chunks_.begin(), state->chunks_.end());
+    for (Chunk* chunk : copy->chunks_) {
+        chunk->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return copy;
 }
 
-// COWVector
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::ReleaseState(State* state) {
+    INSTRUMENT_REF_COUNT(COW_VECTOR_STATE);
+    if (state->ref_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    for (Chunk* chunk : state->chunks_) {
+        ReleaseChunk(state->alloc_, chunk);
+    }
+    StateAlloc state_alloc(state->alloc_);
+    state->~State();
+    std::allocator_traits<StateAlloc>::deallocate(state_alloc, state, 1);
+}
 
-COWVector::COWVector() : state_(new State()) {
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::NewChunk(Alloc& alloc) -> Chunk* {
+    ChunkAlloc chunk_alloc(alloc);
+    Chunk* chunk = std::allocator_traits<ChunkAlloc>::allocate(chunk_alloc, 1);
+    INSTRUMENT_ALLOCATION(COW_VECTOR_CHUNK, sizeof(Chunk));
+    return new (chunk) Chunk();
 }
 
-COWVector::~COWVector() {
-    --state_->ref_count_;
-    if (state_->ref_count_ == 0) {
-        delete state_;
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::CloneChunk(Alloc& alloc, Chunk* chunk) -> Chunk* {
+    Chunk* copy = NewChunk(alloc);
+    INSTRUMENT_COPY_ON_WRITE(COW_VECTOR_CHUNK);
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        std::memcpy(copy->storage_, chunk->storage_, chunk->size_ * sizeof(T));
+        copy->size_ = chunk->size_;
+    } else {
+        try {
+            for (; copy->size_ < chunk->size_; ++copy->size_) {
+                AllocTraits::construct(alloc, copy->Data() + copy->size_,
+                                       chunk->Data()[copy->size_]);
+            }
+        } catch (...) {
+            ReleaseChunk(alloc, copy);
+            throw;
+        }
     }
+    return copy;
 }
 
-COWVector::COWVector(const COWVector& other) : state_(other.state_) {
-    ++state_->ref_count_;
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::ReleaseChunk(Alloc& alloc, Chunk* chunk) {
+    INSTRUMENT_REF_COUNT(COW_VECTOR_CHUNK);
+    if (chunk->ref_count_.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+    ShrinkChunk(alloc, chunk, 0);
+    ChunkAlloc chunk_alloc(alloc);
+    chunk->~Chunk();
+    std::allocator_traits<ChunkAlloc>::deallocate(chunk_alloc, chunk, 1);
 }
 
-COWVector& COWVector::operator=(const COWVector& other) {
-    --state_->ref_count_;
-    if (state_->ref_count_ == 0) {
-        delete state_;
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::ShrinkChunk(Alloc& alloc, Chunk* chunk, size_t size) {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = size; i < chunk->size_; ++i) {
+            AllocTraits::destroy(alloc, chunk->Data() + i);
+        }
     }
+    chunk->size_ = size;
+}
+
+// COWVector
+
+template <typename T, typename Alloc>
+COWVector<T, Alloc>::COWVector(const Alloc& alloc) : state_(NewState(alloc)) {
+}
+
+template <typename T, typename Alloc>
+COWVector<T, Alloc>::~COWVector() {
+    ReleaseState(state_);
+}
+
+template <typename T, typename Alloc>
+COWVector<T, Alloc>::COWVector(const COWVector& other) : state_(other.state_) {
+    INSTRUMENT_REF_COUNT(COW_VECTOR_STATE);
+    state_->ref_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename T, typename Alloc>
+COWVector<T, Alloc>& COWVector<T, Alloc>::operator=(const COWVector& other) {
+    INSTRUMENT_REF_COUNT(COW_VECTOR_STATE);
+    other.state_->ref_count_.fetch_add(1, std::memory_order_relaxed);
+    ReleaseState(state_);
     state_ = other.state_;
-    ++state_->ref_count_;
     return *this;
 }
 
-size_t COWVector::Size() const {
-    return state_->storage_.size();
+template <typename T, typename Alloc>
+size_t COWVector<T, Alloc>::Size() const {
+    return state_->size_;
+}
+
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Resize(size_t size) {
+    CopyState(size);
+    auto& chunks = state_->chunks_;
+    size_t chunk_count = (size + kChunkSize - 1) / kChunkSize;
+    while (chunks.size() > chunk_count) {
+        ReleaseChunk(state_->alloc_, chunks.back());
+        chunks.pop_back();
+    }
+    chunks.reserve(chunk_count);
+    size_t old_size = state_->size_;
+    size_t old_chunk_count = chunks.size();
+    // Only the last chunk can be partially filled
+    size_t first = std::min(old_size / kChunkSize, chunk_count > 0 ? chunk_count - 1 : 0);
+    try {
+        for (size_t i = first; i < chunk_count; ++i) {
+            if (i == chunks.size()) {
+                chunks.push_back(NewChunk(state_->alloc_));
+            }
+            size_t chunk_size = i + 1 < chunk_count ? kChunkSize : size - i * kChunkSize;
+            if (chunks[i]->size_ == chunk_size) {
+                continue;
+            }
+            Chunk* chunk = CopyChunk(i);
+            ShrinkChunk(state_->alloc_, chunk, std::min(chunk->size_, chunk_size));
+            for (; chunk->size_ < chunk_size; ++chunk->size_) {
+                AllocTraits::construct(state_->alloc_, chunk->Data() + chunk->size_);
+            }
+        }
+    } catch (...) {
+        // Only growth constructs elements: drop what was added and keep the old size
+        while (chunks.size() > old_chunk_count) {
+            ReleaseChunk(state_->alloc_, chunks.back());
+            chunks.pop_back();
+        }
+        if (old_chunk_count > 0) {
+            size_t last_size = old_size - (old_chunk_count - 1) * kChunkSize;
+            if (chunks.back()->size_ > last_size) {
+                ShrinkChunk(state_->alloc_, chunks.back(), last_size);
+            }
+        }
+        throw;
+    }
+    state_->size_ = size;
+}
+
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Reserve(size_t size) {
+    CopyState(size, false);
+    state_->chunks_.reserve((size + kChunkSize - 1) / kChunkSize);
+}
+
+template <typename T, typename Alloc>
+const T& COWVector<T, Alloc>::Get(size_t at) const {
+    if (IsMapped(state_)) [[unlikely]] {
+        Materialize(state_);
+    }
+    return state_->chunks_[at / kChunkSize]->Data()[at % kChunkSize];
+}
+
+template <typename T, typename Alloc>
+const T& COWVector<T, Alloc>::Back() const {
+    return Get(state_->size_ - 1);
 }
 
-void COWVector::Resize(size_t size) {
-    CopyState();
-    state_->storage_.resize(size);
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::PushBack(const T& value) {
+    EmplaceBack(value);
 }
 
-const std::string& COWVector::Get(size_t at) const {
-    return state_->storage_[at];
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::PushBack(T&& value) {
+    EmplaceBack(std::move(value));
 }
 
-const std::string& COWVector::Back() const {
-    return state_->storage_.back();
+template <typename T, typename Alloc>
+template <typename... Args>
+void COWVector<T, Alloc>::EmplaceBack(Args&&... args) {
+    CopyState(state_->size_ + 1);
+    if (state_->size_ % kChunkSize == 0) {
+        // The chunk is published only once the element is in it, so a throwing constructor
+        // leaves the table as it was
+        Chunk* chunk = NewChunk(state_->alloc_);
+        try {
+            AllocTraits::construct(state_->alloc_, chunk->Data(), std::forward<Args>(args)...);
+            chunk->size_ = 1;
+            state_->chunks_.push_back(chunk);
+        } catch (...) {
+            ReleaseChunk(state_->alloc_, chunk);
+            throw;
+        }
+        ++state_->size_;
+        return;
+    }
+    Chunk* chunk = CopyChunk(state_->chunks_.size() - 1);
+    AllocTraits::construct(state_->alloc_, chunk->Data() + chunk->size_,
+                           std::forward<Args>(args)...);
+    ++chunk->size_;
+    ++state_->size_;
 }
 
-void COWVector::PushBack(const std::string& value) {
-    CopyState();
-    state_->storage_.push_back(value);
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Set(size_t at, const T& value) {
+    CopyState(state_->size_);
+    CopyChunk(at / kChunkSize)->Data()[at % kChunkSize] = value;
 }
 
-void COWVector::Set(size_t at, const std::string& value) {
-    CopyState();
-    state_->storage_[at] = value;
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Set(size_t at, T&& value) {
+    CopyState(state_->size_);
+    CopyChunk(at / kChunkSize)->Data()[at % kChunkSize] = std::move(value);
 }
 
-void COWVector::CopyState() {
-    if (state_->ref_count_ > 1) {
-        --state_->ref_count_;
-        State* new_state = new State(*state_);
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::CopyState(size_t capacity, bool new_version) {
+    if (IsMapped(state_)) [[unlikely]] {
+        Materialize(state_);
+    }
+    if (state_->ref_count_.load(std::memory_order_acquire) > 1) {
+        State* new_state = CloneState(state_, capacity);
+        if (!new_version) {
+            new_state->version_ = state_->version_;
+        }
+        ReleaseState(state_);
         state_ = new_state;
+    } else if (new_version) {
+        state_->version_ = NextVersion();
     }
-}
\ No newline at end of file
+}
+
+// Makes the chunk at `index` owned by this state alone; `state_` must already be unique
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::CopyChunk(size_t index) -> Chunk* {
+    Chunk*& chunk = state_->chunks_[index];
+    if (chunk->ref_count_.load(std::memory_order_acquire) > 1) {
+        Chunk* copy = CloneChunk(state_->alloc_, chunk);
+        ReleaseChunk(state_->alloc_, chunk);
+        chunk = copy;
+    }
+    return chunk;
+}
+
+template <typename T, typename Alloc>
+uint64_t COWVector<T, Alloc>::Version() const {
+    return state_->version_;
+}
+
+template <typename T, typename Alloc>
+auto COWVector<T, Alloc>::Diff(const COWVector& from, const COWVector& to)
+    -> std::vector<IndexRange> {
+    std::vector<IndexRange> ranges;
+    if (from.state_ == to.state_) {
+        return ranges;
+    }
+    auto add = [&ranges](size_t begin, size_t end) {
+        if (!ranges.empty() && ranges.back().end == begin) {
+            ranges.back().end = end;
+        } else {
+            ranges.push_back({begin, end});
+        }
+    };
+    for (const State* state : {from.state_, to.state_}) {
+        if (IsMapped(state)) {
+            Materialize(const_cast<State*>(state));
+        }
+    }
+    size_t common = std::min(from.Size(), to.Size());
+    for (size_t index = 0; index * kChunkSize < common; ++index) {
+        Chunk* left = from.state_->chunks_[index];
+        Chunk* right = to.state_->chunks_[index];
+        if (left == right) {
+            continue;
+        }
+        size_t begin = index * kChunkSize;
+        size_t end = std::min(begin + kChunkSize, common);
+        if constexpr (std::equality_comparable<T>) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!(left->Data()[i - begin] == right->Data()[i - begin])) {
+                    add(i, i + 1);
+                }
+            }
+        } else {
+            add(begin, end);
+        }
+    }
+    if (from.Size() != to.Size()) {
+        add(common, std::max(from.Size(), to.Size()));
+    }
+    return ranges;
+}
+
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Materialize(State* state) {
+    if constexpr (std::is_constructible_v<T, std::string_view>) {
+        MappedFile* mapped = state->mapped_;
+        std::lock_guard<std::mutex> lock(mapped->mutex_);
+        if (mapped->materialized_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        auto& chunks = state->chunks_;
+        chunks.reserve((mapped->Size() + kChunkSize - 1) / kChunkSize);
+        try {
+            for (size_t begin = 0; begin < mapped->Size(); begin += kChunkSize) {
+                Chunk* chunk = NewChunk(state->alloc_);
+                // Reserved above, so publishing the chunk cannot throw
+                chunks.push_back(chunk);
+                size_t end = std::min(begin + kChunkSize, mapped->Size());
+                for (size_t i = begin; i < end; ++i) {
+                    AllocTraits::construct(state->alloc_, chunk->Data() + chunk->size_,
+                                           mapped->Get(i));
+                    ++chunk->size_;
+                }
+            }
+        } catch (...) {
+            // Start over on the next access
+            for (Chunk* chunk : chunks) {
+                ReleaseChunk(state->alloc_, chunk);
+            }
+            chunks.clear();
+            throw;
+        }
+        mapped->materialized_.store(true, std::memory_order_release);
+    }
+}
+
+template <typename T, typename Alloc>
+void COWVector<T, Alloc>::Save(const std::string& path) const
+    requires std::is_convertible_v<const T&, std::string_view>
+{
+    uint64_t count = Size();
+    std::vector<uint64_t> offsets(count + 1, 0);
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i + 1] = offsets[i] + View(i).size();
+    }
+    // `path` may still be mapped by `MapFile`, and truncating it in place would turn reads of
+    // that mapping into SIGBUS. The snapshot goes to a new file that replaces it atomically;
+    // existing mappings keep the old inode.
+    std::string temp_path = path + ".tmp";
+    std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+    out.write(MappedFile::kMagic, sizeof(MappedFile::kMagic));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for (size_t i = 0; i < count; ++i) {
+        std::string_view value = View(i);
+        out.write(value.data(), value.size());
+    }
+    out.close();
+    int fd = out ? open(temp_path.c_str(), O_RDONLY | O_CLOEXEC) : -1;
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!synced || rename(temp_path.c_str(), path.c_str()) != 0) {
+        unlink(temp_path.c_str());
+        throw std::runtime_error("COWVector: cannot write " + path);
+    }
+}
+
+template <typename T, typename Alloc>
+COWVector<T, Alloc> COWVector<T, Alloc>::MapFile(const std::string& path, const Alloc& alloc)
+    requires std::is_constructible_v<T, std::string_view>
+{
+    auto mapped = std::make_unique<MappedFile>(path);
+    State* state = NewState(alloc);
+    state->size_ = mapped->Size();
+    state->mapped_ = mapped.release();
+    return COWVector(state);
+}
+
+template <typename T, typename Alloc>
+std::string_view COWVector<T, Alloc>::View(size_t at) const
+    requires std::is_convertible_v<const T&, std::string_view>
+{
+    if (IsMapped(state_)) {
+        return state_->mapped_->Get(at);
+    }
+    return state_->chunks_[at / kChunkSize]->Data()[at % kChunkSize];
+}
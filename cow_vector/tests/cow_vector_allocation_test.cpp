@@ -0,0 +1,215 @@
+#include <cow_vector.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace {
+
+// Counts every allocation of the vector: states, chunks and chunk tables all go through
+// rebinds of the element allocator. Tables are the only arrays of pointers.
+struct AllocationCounts {
+    static inline size_t allocations = 0;
+    static inline size_t table_allocations = 0;
+
+    static void Reset() {
+        allocations = 0;
+        table_allocations = 0;
+    }
+};
+
+template <typename T>
+struct CountingAlloc {
+    using value_type = T;
+
+    CountingAlloc() = default;
+
+    template <typename U>
+    CountingAlloc(const CountingAlloc<U>&) {
+    }
+
+    T* allocate(size_t n) {
+        ++AllocationCounts::allocations;
+        if constexpr (std::is_pointer_v<T>) {
+            ++AllocationCounts::table_allocations;
+        }
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAlloc<U>&) const {
+        return true;
+    }
+};
+
+// String wrapper counting how it was built and written
+struct Tracked {
+    static inline int constructions = 0;
+    static inline int copies = 0;
+    static inline int moves = 0;
+    static inline int view_assignments = 0;
+
+    std::string value;
+
+    static void Reset() {
+        constructions = 0;
+        copies = 0;
+        moves = 0;
+        view_assignments = 0;
+    }
+
+    Tracked() {
+        ++constructions;
+    }
+
+    explicit Tracked(std::string_view view) : value(view) {
+        ++constructions;
+    }
+
+    Tracked(const Tracked& other) : value(other.value) {
+        ++copies;
+    }
+
+    Tracked(Tracked&& other) noexcept : value(std::move(other.value)) {
+        ++moves;
+    }
+
+    Tracked& operator=(const Tracked& other) {
+        value = other.value;
+        ++copies;
+        return *this;
+    }
+
+    Tracked& operator=(Tracked&& other) noexcept {
+        value = std::move(other.value);
+        ++moves;
+        return *this;
+    }
+
+    Tracked& operator=(std::string_view view) {
+        value = view;
+        ++view_assignments;
+        return *this;
+    }
+};
+
+}  // namespace
+
+TEST(COWVectorAllocation, PushBackRvalueMoves) {
+    COWVector<Tracked> vector;
+    Tracked value("payload");
+    Tracked::Reset();
+    vector.PushBack(std::move(value));
+    EXPECT_EQ(Tracked::moves, 1);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(vector.Get(0).value, "payload");
+}
+
+TEST(COWVectorAllocation, EmplaceBackBuildsInPlace) {
+    COWVector<Tracked> vector;
+    Tracked::Reset();
+    vector.EmplaceBack(std::string_view("payload"));
+    vector.EmplaceBack();
+    EXPECT_EQ(Tracked::constructions, 2);
+    EXPECT_EQ(Tracked::moves, 0);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(vector.Get(0).value, "payload");
+}
+
+TEST(COWVectorAllocation, SetRvalueMoves) {
+    COWVector<Tracked> vector;
+    vector.EmplaceBack(std::string_view("old"));
+    Tracked value("new");
+    Tracked::Reset();
+    vector.Set(0, std::move(value));
+    EXPECT_EQ(Tracked::moves, 1);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(vector.Get(0).value, "new");
+}
+
+TEST(COWVectorAllocation, SetViewAssignsInPlace) {
+    COWVector<Tracked> vector;
+    vector.EmplaceBack(std::string_view("old"));
+    Tracked::Reset();
+    vector.Set(0, std::string_view("new"));
+    EXPECT_EQ(Tracked::view_assignments, 1);
+    EXPECT_EQ(Tracked::constructions, 0);
+    EXPECT_EQ(Tracked::moves, 0);
+    EXPECT_EQ(Tracked::copies, 0);
+    EXPECT_EQ(vector.Get(0).value, "new");
+}
+
+TEST(COWVectorAllocation, WriteToSharedChunkCopiesItOnce) {
+    COWVector<Tracked> original;
+    for (size_t i = 0; i < COWVector<Tracked>::kChunkSize * 2; ++i) {
+        original.EmplaceBack(std::string_view("value"));
+    }
+    COWVector<Tracked> copy = original;
+    Tracked::Reset();
+    copy.Set(0, std::string_view("changed"));
+    copy.Set(1, std::string_view("changed"));
+    // Only the written chunk is cloned, and only on the first write
+    EXPECT_EQ(Tracked::copies, static_cast<int>(COWVector<Tracked>::kChunkSize));
+    EXPECT_EQ(Tracked::view_assignments, 2);
+    EXPECT_EQ(original.Get(0).value, "value");
+}
+
+TEST(COWVectorAllocation, ReserveOnSharedVectorClonesWithCapacity) {
+    using Vector = COWVector<int, CountingAlloc<int>>;
+    constexpr size_t kFullChunks = 3;
+    Vector original;
+    for (size_t i = 0; i < kFullChunks * Vector::kChunkSize; ++i) {
+        original.PushBack(static_cast<int>(i));
+    }
+    Vector copy = original;
+    AllocationCounts::Reset();
+    copy.Reserve(kFullChunks * Vector::kChunkSize + 1);
+    // One state and one table sized for the new chunk
+    EXPECT_EQ(AllocationCounts::allocations, 2u);
+    EXPECT_EQ(AllocationCounts::table_allocations, 1u);
+    copy.PushBack(-1);
+    // The new chunk, and no regrowth of the table
+    EXPECT_EQ(AllocationCounts::allocations, 3u);
+    EXPECT_EQ(AllocationCounts::table_allocations, 1u);
+    EXPECT_EQ(original.Size(), kFullChunks * Vector::kChunkSize);
+    EXPECT_EQ(copy.Back(), -1);
+}
+
+TEST(COWVectorAllocation, WriteToSharedVectorClonesTableOnce) {
+    using Vector = COWVector<int, CountingAlloc<int>>;
+    Vector original;
+    for (size_t i = 0; i < Vector::kChunkSize; ++i) {
+        original.PushBack(static_cast<int>(i));
+    }
+    Vector copy = original;
+    AllocationCounts::Reset();
+    // The table is cloned with room for the appended element's chunk
+    copy.PushBack(-1);
+    EXPECT_EQ(AllocationCounts::allocations, 3u);
+    EXPECT_EQ(AllocationCounts::table_allocations, 1u);
+    AllocationCounts::Reset();
+    for (size_t i = 1; i < Vector::kChunkSize; ++i) {
+        copy.PushBack(-1);
+    }
+    EXPECT_EQ(AllocationCounts::allocations, 0u);
+}
+
+TEST(COWVectorAllocation, ReserveAvoidsTableRegrowth) {
+    using Vector = COWVector<int, CountingAlloc<int>>;
+    constexpr size_t kChunks = 16;
+    Vector vector;
+    AllocationCounts::Reset();
+    vector.Reserve(kChunks * Vector::kChunkSize);
+    for (size_t i = 0; i < kChunks * Vector::kChunkSize; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    EXPECT_EQ(AllocationCounts::table_allocations, 1u);
+    EXPECT_EQ(AllocationCounts::allocations, kChunks + 1);
+}
@@ -0,0 +1,116 @@
+#include <cow_vector.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kChunkSize = COWVector<int>::kChunkSize;
+
+COWVector<int> Iota(size_t size) {
+    COWVector<int> vector;
+    for (size_t i = 0; i < size; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    return vector;
+}
+
+}  // namespace
+
+TEST(COWVectorMutate, IndexedWrites) {
+    COWVector<std::string> vector;
+    for (int i = 0; i < 100; ++i) {
+        vector.PushBack(std::to_string(i));
+    }
+    uint64_t version = vector.Version();
+    size_t size = vector.Mutate([](auto& view) {
+        view[3] = "three";
+        view[99] += "!";
+        return view.Size();
+    });
+    EXPECT_EQ(size, 100u);
+    EXPECT_EQ(vector.Get(3), "three");
+    EXPECT_EQ(vector.Get(99), "99!");
+    EXPECT_EQ(vector.Get(4), "4");
+    EXPECT_NE(vector.Version(), version);
+}
+
+TEST(COWVectorMutate, ChunkSpansCoverTheVector) {
+    COWVector<int> vector = Iota(2 * kChunkSize + 5);
+    vector.Mutate([](auto& view) {
+        ASSERT_EQ(view.ChunkCount(), 3u);
+        EXPECT_EQ(view.ChunkSpan(0).size(), kChunkSize);
+        EXPECT_EQ(view.ChunkSpan(2).size(), 5u);
+        EXPECT_EQ(view.ChunkSpan(1)[0], static_cast<int>(kChunkSize));
+        view.ForEachChunk([](std::span<int> chunk) {
+            for (int& value : chunk) {
+                value *= 2;
+            }
+        });
+    });
+    for (size_t i = 0; i < vector.Size(); ++i) {
+        ASSERT_EQ(vector.Get(i), static_cast<int>(2 * i));
+    }
+}
+
+TEST(COWVectorMutate, SortThroughIterators) {
+    COWVector<int> vector;
+    for (size_t i = 0; i < 3 * kChunkSize; ++i) {
+        vector.PushBack(static_cast<int>((i * 7919) % 1000));
+    }
+    std::vector<int> expected;
+    for (size_t i = 0; i < vector.Size(); ++i) {
+        expected.push_back(vector.Get(i));
+    }
+    std::sort(expected.begin(), expected.end());
+    vector.Mutate([](auto& view) { std::sort(view.begin(), view.end()); });
+    for (size_t i = 0; i < vector.Size(); ++i) {
+        ASSERT_EQ(vector.Get(i), expected[i]);
+    }
+}
+
+TEST(COWVectorMutate, EarlierCopiesStayUnchanged) {
+    COWVector<int> vector = Iota(3 * kChunkSize);
+    COWVector<int> snapshot = vector;
+    vector.Mutate([](auto& view) {
+        view[0] = -1;
+        view[2 * kChunkSize] = -2;
+    });
+    EXPECT_EQ(vector.Get(0), -1);
+    EXPECT_EQ(vector.Get(2 * kChunkSize), -2);
+    for (size_t i = 0; i < snapshot.Size(); ++i) {
+        ASSERT_EQ(snapshot.Get(i), static_cast<int>(i));
+    }
+    EXPECT_EQ(COWVector<int>::Diff(snapshot, vector),
+              (std::vector<COWVector<int>::IndexRange>{{0, 1},
+                                                       {2 * kChunkSize, 2 * kChunkSize + 1}}));
+}
+
+TEST(COWVectorMutate, ChunksWrittenFromDifferentThreads) {
+    constexpr size_t kThreads = 4;
+    COWVector<int> vector = Iota(16 * kChunkSize + 3);
+    COWVector<int> snapshot = vector;
+    vector.Mutate([](auto& view) {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < kThreads; ++t) {
+            threads.emplace_back([&view, t] {
+                for (size_t chunk = t; chunk < view.ChunkCount(); chunk += kThreads) {
+                    for (int& value : view.ChunkSpan(chunk)) {
+                        value = -value;
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    });
+    for (size_t i = 0; i < vector.Size(); ++i) {
+        ASSERT_EQ(vector.Get(i), -static_cast<int>(i));
+        ASSERT_EQ(snapshot.Get(i), static_cast<int>(i));
+    }
+}
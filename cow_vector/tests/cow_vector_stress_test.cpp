@@ -0,0 +1,122 @@
+#include <cow_vector.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Trivially copyable, so chunks are cloned with memcpy
+struct Record {
+    int64_t id;
+    int64_t value;
+    int64_t check;
+};
+
+Record MakeRecord(int64_t id, int64_t value) {
+    return {id, value, id ^ value};
+}
+
+int64_t Sum(const COWVector<Record>& snapshot, std::atomic<int>* errors) {
+    int64_t sum = 0;
+    for (size_t i = 0; i < snapshot.Size(); ++i) {
+        const Record& record = snapshot.Get(i);
+        if (record.id != static_cast<int64_t>(i) || record.check != (record.id ^ record.value)) {
+            ++*errors;
+        }
+        sum += record.value;
+    }
+    return sum;
+}
+
+}  // namespace
+
+// One writer keeps writing its own handle and publishes copies; readers take copies of the
+// published snapshot, read them without any lock while the writer goes on, copy and drop them
+// again. Each snapshot must stay intact and unchanged for as long as a reader holds it.
+TEST(COWVectorStress, SnapshotsHandedToReaderThreads) {
+    constexpr int kReaders = 4;
+    constexpr size_t kSize = 1000;
+    constexpr int kWrites = 20000;
+
+    COWVector<Record> local;
+    for (size_t i = 0; i < kSize; ++i) {
+        local.PushBack(MakeRecord(i, 0));
+    }
+    std::mutex mutex;
+    COWVector<Record> published = local;
+    std::atomic<bool> done = false;
+    std::atomic<int> errors = 0;
+    std::atomic<int> reads = 0;
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < kReaders; ++r) {
+        readers.emplace_back([&] {
+            do {
+                COWVector<Record> snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    snapshot = published;
+                }
+                uint64_t version = snapshot.Version();
+                int64_t first = Sum(snapshot, &errors);
+                COWVector<Record> copy = snapshot;
+                std::this_thread::yield();
+                if (Sum(copy, &errors) != first || snapshot.Version() != version) {
+                    ++errors;
+                }
+                ++reads;
+            } while (!done.load(std::memory_order_relaxed));
+        });
+    }
+
+    for (int w = 0; w < kWrites; ++w) {
+        local.Set(static_cast<size_t>(w * 7919) % kSize, MakeRecord(w * 7919 % kSize, w));
+        if (w % 10 == 0) {
+            local.PushBack(MakeRecord(local.Size(), w));
+        }
+        if (w % 50 == 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                published = local;
+            }
+            // Lets the readers in even on a single core
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+    EXPECT_GE(reads.load(), kReaders);
+    EXPECT_EQ(local.Size(), kSize + kWrites / 10);
+}
+
+// Many threads copying and dropping handles to one shared state at the same time
+TEST(COWVectorStress, ConcurrentCopiesOfOneHandle) {
+    COWVector<std::string> shared;
+    for (int i = 0; i < 300; ++i) {
+        shared.PushBack(std::to_string(i));
+    }
+    std::vector<std::thread> threads;
+    std::atomic<int> errors = 0;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 2000; ++i) {
+                COWVector<std::string> copy = shared;
+                copy.Set(i % 300, "thread " + std::to_string(t));
+                if (shared.Get(i % 300) != std::to_string(i % 300)) {
+                    ++errors;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(errors.load(), 0);
+}
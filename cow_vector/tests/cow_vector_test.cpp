@@ -0,0 +1,171 @@
+#include <cow_vector.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+struct ThrowsOn {
+    static inline int alive = 0;
+    static inline int poison = -1;
+
+    int value;
+
+    ThrowsOn(int value) : value(value) {
+        if (value == poison) {
+            throw std::runtime_error("poison");
+        }
+        ++alive;
+    }
+
+    ThrowsOn(const ThrowsOn& other) : value(other.value) {
+        ++alive;
+    }
+
+    ThrowsOn& operator=(const ThrowsOn&) = default;
+
+    ~ThrowsOn() {
+        --alive;
+    }
+};
+
+std::string TempPath(const char* name) {
+    return testing::TempDir() + name + std::to_string(getpid());
+}
+
+}  // namespace
+
+TEST(COWVector, CopiesShareUntilWritten) {
+    COWVector<std::string> original;
+    for (int i = 0; i < 200; ++i) {
+        original.PushBack(std::to_string(i));
+    }
+    COWVector<std::string> copy = original;
+    EXPECT_EQ(copy.Version(), original.Version());
+    copy.Set(100, "changed");
+    copy.PushBack("tail");
+    EXPECT_EQ(original.Get(100), "100");
+    EXPECT_EQ(original.Size(), 200u);
+    EXPECT_EQ(copy.Get(100), "changed");
+    EXPECT_EQ(copy.Back(), "tail");
+    EXPECT_NE(copy.Version(), original.Version());
+}
+
+TEST(COWVector, ResizeShrinksAndGrows) {
+    COWVector<int> vector;
+    vector.Resize(130);
+    vector.Set(129, 7);
+    COWVector<int> snapshot = vector;
+    vector.Resize(10);
+    vector.Resize(70);
+    EXPECT_EQ(vector.Get(69), 0);
+    EXPECT_EQ(snapshot.Size(), 130u);
+    EXPECT_EQ(snapshot.Get(129), 7);
+}
+
+TEST(COWVector, DiffReportsChangedRanges) {
+    COWVector<int> from;
+    for (int i = 0; i < 300; ++i) {
+        from.PushBack(i);
+    }
+    COWVector<int> to = from;
+    to.Set(5, -1);
+    to.Set(6, -1);
+    to.Set(250, -1);
+    to.PushBack(300);
+    using Range = COWVector<int>::IndexRange;
+    EXPECT_EQ(COWVector<int>::Diff(from, to),
+              (std::vector<Range>{{5, 7}, {250, 251}, {300, 301}}));
+    EXPECT_TRUE(COWVector<int>::Diff(from, from).empty());
+}
+
+TEST(COWVector, VersionChangesOnlyWithTheContents) {
+    COWVector<int> vector;
+    vector.PushBack(1);
+    uint64_t version = vector.Version();
+    vector.Reserve(1000);
+    EXPECT_EQ(vector.Version(), version);
+    COWVector<int> copy = vector;
+    copy.Reserve(2000);
+    EXPECT_EQ(copy.Version(), version);
+    EXPECT_TRUE(COWVector<int>::Diff(vector, copy).empty());
+    copy.PushBack(2);
+    EXPECT_NE(copy.Version(), version);
+    EXPECT_EQ(vector.Version(), version);
+}
+
+TEST(COWVector, ThrowingConstructorLeavesNoEmptyChunk) {
+    {
+        COWVector<ThrowsOn> vector;
+        for (int i = 0; i < 64; ++i) {
+            vector.EmplaceBack(i);
+        }
+        ThrowsOn::poison = 64;
+        EXPECT_THROW(vector.EmplaceBack(64), std::runtime_error);
+        ThrowsOn::poison = -1;
+        EXPECT_EQ(vector.Size(), 64u);
+        vector.EmplaceBack(65);
+        EXPECT_EQ(vector.Back().value, 65);
+        EXPECT_EQ(vector.Size(), 65u);
+    }
+    EXPECT_EQ(ThrowsOn::alive, 0);
+}
+
+TEST(COWVector, SaveAndMapFile) {
+    std::string path = TempPath("cow_vector_snapshot");
+    COWVector<std::string> vector;
+    for (int i = 0; i < 100; ++i) {
+        vector.PushBack(std::string(i % 7, 'a' + i % 26));
+    }
+    vector.Save(path);
+    auto mapped = COWVector<std::string>::MapFile(path);
+    ASSERT_EQ(mapped.Size(), 100u);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(mapped.View(i), vector.Get(i));
+    }
+    mapped.Set(3, "written");
+    EXPECT_EQ(mapped.Get(3), "written");
+    EXPECT_EQ(mapped.Get(4), vector.Get(4));
+    std::remove(path.c_str());
+}
+
+TEST(COWVector, SaveOverMappedFile) {
+    std::string path = TempPath("cow_vector_resave");
+    COWVector<std::string> vector;
+    for (int i = 0; i < 1000; ++i) {
+        vector.PushBack(std::string(64, 'a' + i % 26));
+    }
+    vector.Save(path);
+    auto mapped = COWVector<std::string>::MapFile(path);
+    COWVector<std::string> shorter;
+    shorter.PushBack("new");
+    shorter.Save(path);
+    // The old mapping still reads the old file, past the size of the new one
+    EXPECT_EQ(mapped.View(999), std::string(64, 'a' + 999 % 26));
+    auto remapped = COWVector<std::string>::MapFile(path);
+    ASSERT_EQ(remapped.Size(), 1u);
+    EXPECT_EQ(remapped.View(0), "new");
+    EXPECT_NE(access((path + ".tmp").c_str(), F_OK), 0);
+    std::remove(path.c_str());
+}
+
+TEST(MappedFile, RejectsOffsetsOutsideTheBlob) {
+    std::string path = TempPath("cow_vector_corrupt");
+    COWVector<std::string> vector;
+    vector.PushBack("ab");
+    vector.PushBack("cde");
+    vector.Save(path);
+    {
+        // offsets[1] points past the end of the blob, offsets[2] is still valid
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t offset = 100;
+        file.seekp(sizeof(MappedFile::kMagic) + 2 * sizeof(uint64_t));
+        file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+    }
+    EXPECT_THROW(MappedFile file(path), std::runtime_error);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,46 @@
+#include <benchmark.h>
+#include <defer.h>
+#include <defer_stack.h>
+
+#include <functional>
+#include <vector>
+
+namespace {
+
+constexpr size_t kCallbacks = 16;
+
+}  // namespace
+
+BENCHMARK(Defer) {
+    int64_t counter = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        Defer defer([&counter] { ++counter; });
+    }
+    DoNotOptimize(counter);
+}
+
+// One scope with `kCallbacks` callbacks; the time is per callback
+BENCHMARK(DeferStackScope) {
+    int64_t counter = 0;
+    for (size_t done = 0; done < iterations; done += kCallbacks) {
+        DeferStack<> stack;
+        for (size_t i = 0; i < kCallbacks; ++i) {
+            stack.Push([&counter, i] { counter += i; });
+        }
+    }
+    DoNotOptimize(counter);
+}
+
+BENCHMARK(VectorOfStdFunctionScope) {
+    int64_t counter = 0;
+    for (size_t done = 0; done < iterations; done += kCallbacks) {
+        std::vector<std::function<void()>> callbacks;
+        for (size_t i = 0; i < kCallbacks; ++i) {
+            callbacks.emplace_back([&counter, i] { counter += i; });
+        }
+        for (auto it = callbacks.rbegin(); it != callbacks.rend(); ++it) {
+            (*it)();
+        }
+    }
+    DoNotOptimize(counter);
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// `Defer` for a number of callbacks known only at runtime. Callbacks of any types are placed
+// one after another into an inline buffer of `InlineBytes` bytes; once it is full the next
+// ones go to heap blocks of an arena, freed all at once. On scope exit the pending callbacks
+// run in reverse order of `Push`, and each of them can also be run or cancelled earlier.
+//
+//     DeferStack<> cleanup;
+//     for (auto& file : files) {
+//         int fd = open(file.c_str(), O_RDONLY);
+//         cleanup.Push([fd] { close(fd); });
+//     }
+template <size_t InlineBytes = 256>
+class DeferStack final {
+private:
+    static constexpr size_t kAlignment = alignof(std::max_align_t);
+    static constexpr size_t kBlockSize = 4096;
+
+    struct EntryBase {
+        // Runs the callback when `invoke` is set, then destroys the callback alone
+        void (*finish)(EntryBase* entry, bool invoke);
+        EntryBase* previous;
+        bool pending;
+    };
+
+    template <typename Callback>
+    struct Entry : EntryBase {
+        Callback callback;
+
+        Entry(EntryBase* previous, Callback&& callback)
+            : EntryBase{&Finish, previous, true}, callback(std::move(callback)) {
+        }
+
+        static void Finish(EntryBase* base, bool invoke) {
+            auto* entry = static_cast<Entry*>(base);
+            if (invoke) {
+                std::move(entry->callback)();
+            }
+            // Only the callback goes: `EntryBase` stays readable through `Handle` and the
+            // `previous` links until the memory is released
+            entry->callback.~Callback();
+        }
+    };
+
+    struct Block {
+        Block* next;
+    };
+
+    alignas(kAlignment) unsigned char inline_buffer_[InlineBytes];
+    unsigned char* cursor_ = inline_buffer_;
+    unsigned char* limit_ = inline_buffer_ + InlineBytes;
+    Block* blocks_ = nullptr;
+    EntryBase* top_ = nullptr;
+    size_t pending_ = 0;
+
+    static unsigned char* AlignUp(unsigned char* pointer, size_t alignment) {
+        auto address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+
+    void* Allocate(size_t size, size_t alignment) {
+        unsigned char* result = AlignUp(cursor_, alignment);
+        if (result > limit_ || static_cast<size_t>(limit_ - result) < size) {
+            size_t header = (sizeof(Block) + kAlignment - 1) / kAlignment * kAlignment;
+            size_t block_size = std::max(kBlockSize, header + size);
+            auto* block = static_cast<Block*>(::operator new(block_size));
+            block->next = blocks_;
+            blocks_ = block;
+            result = reinterpret_cast<unsigned char*>(block) + header;
+            limit_ = reinterpret_cast<unsigned char*>(block) + block_size;
+        }
+        cursor_ = result + size;
+        return result;
+    }
+
+    void Finish(EntryBase* entry, bool invoke) {
+        if (entry->pending) {
+            entry->pending = false;
+            --pending_;
+            entry->finish(entry, invoke);
+        }
+    }
+
+    void FinishAll(bool invoke) {
+        while (top_) {
+            EntryBase* entry = top_;
+            top_ = entry->previous;
+            Finish(entry, invoke);
+        }
+        while (blocks_) {
+            ::operator delete(std::exchange(blocks_, blocks_->next));
+        }
+        cursor_ = inline_buffer_;
+        limit_ = inline_buffer_ + InlineBytes;
+    }
+
+public:
+    // Refers to one pushed callback; valid until `InvokeAll`, `CancelAll` or destruction
+    class Handle {
+    private:
+        EntryBase* entry_;
+
+        explicit Handle(EntryBase* entry) : entry_(entry) {
+        }
+
+        friend class DeferStack;
+    };
+
+    DeferStack() = default;
+
+    DeferStack(const DeferStack&) = delete;
+    DeferStack& operator=(const DeferStack&) = delete;
+
+    ~DeferStack() {
+        InvokeAll();
+    }
+
+    template <typename Callback>
+    Handle Push(Callback callback) {
+        using Stored = Entry<Callback>;
+        static_assert(alignof(Stored) <= kAlignment, "over-aligned callbacks are not supported");
+        void* memory = Allocate(sizeof(Stored), alignof(Stored));
+        top_ = ::new (memory) Stored(top_, std::move(callback));
+        ++pending_;
+        return Handle(top_);
+    }
+
+    // Runs the callback now instead of on scope exit. Does nothing if it already ran or was
+    // cancelled
+    void Invoke(Handle handle) {
+        Finish(handle.entry_, true);
+    }
+
+    void Cancel(Handle handle) {
+        Finish(handle.entry_, false);
+    }
+
+    // Runs all pending callbacks, last pushed first, and releases the arena
+    void InvokeAll() {
+        FinishAll(true);
+    }
+
+    void CancelAll() {
+        FinishAll(false);
+    }
+
+    size_t Size() const {
+        return pending_;
+    }
+
+    bool Empty() const {
+        return pending_ == 0;
+    }
+};
@@ -0,0 +1,81 @@
+#include <defer.h>
+#include <defer_stack.h>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(Defer, RunsOnScopeExitUnlessCancelled) {
+    int runs = 0;
+    {
+        Defer defer([&runs] { ++runs; });
+    }
+    EXPECT_EQ(runs, 1);
+    {
+        Defer defer([&runs] { ++runs; });
+        defer.Cancel();
+    }
+    EXPECT_EQ(runs, 1);
+    {
+        Defer defer([&runs] { ++runs; });
+        defer.Invoke();
+        defer.Invoke();
+    }
+    EXPECT_EQ(runs, 2);
+}
+
+TEST(DeferStack, RunsInReverseOrderOfPush) {
+    std::vector<int> order;
+    {
+        DeferStack<> stack;
+        for (int i = 0; i < 5; ++i) {
+            stack.Push([&order, i] { order.push_back(i); });
+        }
+        EXPECT_EQ(stack.Size(), 5u);
+    }
+    EXPECT_EQ(order, (std::vector<int>{4, 3, 2, 1, 0}));
+}
+
+TEST(DeferStack, SpillsPastTheInlineBuffer) {
+    int sum = 0;
+    {
+        DeferStack<64> stack;
+        for (int i = 0; i < 1000; ++i) {
+            stack.Push([&sum, i, padding = std::string(i % 50, 'x')] { sum += i; });
+        }
+    }
+    EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+
+TEST(DeferStack, InvokeAndCancelSingleEntries) {
+    auto resource = std::make_shared<int>(0);
+    int runs = 0;
+    {
+        DeferStack<> stack;
+        auto first = stack.Push([resource, &runs] { ++runs; });
+        auto second = stack.Push([resource, &runs] { ++runs; });
+        stack.Invoke(first);
+        stack.Invoke(first);
+        stack.Cancel(second);
+        // Finished entries release their callbacks right away
+        EXPECT_EQ(resource.use_count(), 1);
+        EXPECT_TRUE(stack.Empty());
+        stack.Cancel(first);
+    }
+    EXPECT_EQ(runs, 1);
+}
+
+TEST(DeferStack, CancelAllDropsEverything) {
+    int runs = 0;
+    DeferStack<> stack;
+    stack.Push([&runs] { ++runs; });
+    stack.Push([&runs] { ++runs; });
+    stack.CancelAll();
+    stack.InvokeAll();
+    EXPECT_EQ(runs, 0);
+    stack.Push([&runs] { ++runs; });
+    stack.InvokeAll();
+    EXPECT_EQ(runs, 1);
+}
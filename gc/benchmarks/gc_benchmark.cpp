@@ -0,0 +1,41 @@
+#include <benchmark.h>
+
+#include <cstddef>
+#include <cstdlib>
+
+extern "C" {
+typedef void (*finalizer_t)(void* ptr, size_t size);
+
+void gc_init(char** argv);
+void* gc_malloc(size_t size, finalizer_t finalizer);
+void gc_collect();
+}
+
+namespace {
+
+constexpr size_t kObjects = 64;
+
+void Finalize(void*, size_t) {
+}
+
+}  // namespace
+
+// `kObjects` allocations dropped and collected; the time is per object. The stack of this
+// function is the root set, so nothing allocated here survives the collection.
+BENCHMARK(GcMallocCollect) {
+    gc_init(static_cast<char**>(__builtin_frame_address(0)));
+    for (size_t done = 0; done < iterations; done += kObjects) {
+        for (size_t i = 0; i < kObjects; ++i) {
+            DoNotOptimize(gc_malloc(32, &Finalize));
+        }
+        gc_collect();
+    }
+}
+
+BENCHMARK(MallocFree) {
+    for (size_t i = 0; i < iterations; ++i) {
+        void* memory = std::malloc(32);
+        DoNotOptimize(memory);
+        std::free(memory);
+    }
+}
@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <stdalign.h>
 
+#include <instrumentation.h>
+
 typedef void (*finalizer_t)(void *ptr, size_t size);
 
 // Двусвязный список для хранения аллокации
@@ -78,6 +80,7 @@ void *gc_malloc(size_t size, finalizer_t finalizer) {
     alloc->finalizer = finalizer;
     alloc->alive = true;
     add_allocation(&gc.allocations, &alloc);
+    INSTRUMENT_ALLOCATION(GC_MALLOC, size);
     return memory;
 }
 
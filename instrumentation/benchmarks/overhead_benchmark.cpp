@@ -0,0 +1,67 @@
+// The same hot paths are built twice: `instrumentation_benchmarks` with the configured
+// CODE_EXAMPLES_INSTRUMENTATION (off by default, so the hooks expand to nothing) and
+// `instrumentation_benchmarks_enabled` with the counters compiled in. With the hooks off,
+// `HookLoop` must match `PlainLoop` and the rest must match the module benchmarks.
+
+#include <benchmark.h>
+#include <cow_vector.h>
+#include <instrumentation.h>
+#include <shared.h>
+
+#include <cstdint>
+
+namespace {
+
+struct Payload {
+    int64_t values[4] = {};
+};
+
+}  // namespace
+
+BENCHMARK(PlainLoop) {
+    for (size_t i = 0; i < iterations; ++i) {
+        DoNotOptimize(i);
+    }
+}
+
+BENCHMARK(HookLoop) {
+    for (size_t i = 0; i < iterations; ++i) {
+        INSTRUMENT_REF_COUNT(SHARED_PTR_REFS);
+        DoNotOptimize(i);
+    }
+}
+
+BENCHMARK(InstrumentedMakeShared) {
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> pointer = MakeShared<Payload>();
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(InstrumentedSharedPtrCopy) {
+    SharedPtr<Payload> pointer = MakeShared<Payload>();
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> copy = pointer;
+        DoNotOptimize(copy.Get());
+    }
+}
+
+BENCHMARK(InstrumentedCOWVectorPushBack) {
+    COWVector<int> vector;
+    for (size_t i = 0; i < iterations; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    DoNotOptimize(vector.Size());
+}
+
+BENCHMARK(InstrumentedCOWVectorCopyOnWrite) {
+    COWVector<int> vector;
+    for (size_t i = 0; i < COWVector<int>::kChunkSize * 16; ++i) {
+        vector.PushBack(static_cast<int>(i));
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        COWVector<int> copy = vector;
+        copy.Set(i % copy.Size(), -1);
+        DoNotOptimize(copy.Get(0));
+    }
+}
@@ -0,0 +1,124 @@
+#include "instrumentation.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+const char* const kSiteNames[INSTRUMENT_SITE_COUNT] = {
+    "make_shared",      "allocate_shared",  "shared_ptr_block", "shared_ptr_refs",
+    "cow_vector_state", "cow_vector_chunk", "gc_malloc",
+};
+
+const char* const kEventNames[INSTRUMENT_EVENT_COUNT] = {
+    "allocations",
+    "bytes",
+    "copies_on_write",
+    "ref_count_ops",
+};
+
+struct ThreadCounters;
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<ThreadCounters*> threads;
+    // Counts of threads that have already finished
+    instrument_counters_t finished{};
+};
+
+// Never destroyed: threads may still finish after static destructors have run
+Registry& GetRegistry() {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+// Set once the thread's counters are gone; counts made later, by destructors of other
+// thread-locals, go straight to the finished totals
+thread_local bool thread_finished = false;
+
+// Written only by the owning thread, so increments need no read-modify-write; the atomics
+// are there for `instrument_snapshot` reading them concurrently
+struct ThreadCounters {
+    std::atomic<uint64_t> values[INSTRUMENT_SITE_COUNT][INSTRUMENT_EVENT_COUNT] = {};
+
+    ThreadCounters() {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.threads.push_back(this);
+    }
+
+    ~ThreadCounters() {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        AddTo(&registry.finished);
+        std::erase(registry.threads, this);
+        thread_finished = true;
+    }
+
+    void AddTo(instrument_counters_t* counters) const {
+        for (size_t site = 0; site < INSTRUMENT_SITE_COUNT; ++site) {
+            for (size_t event = 0; event < INSTRUMENT_EVENT_COUNT; ++event) {
+                counters->values[site][event] +=
+                    values[site][event].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+thread_local ThreadCounters thread_counters;
+
+}  // namespace
+
+void instrument_record(instrument_site_t site, instrument_event_t event, uint64_t amount) {
+    if (thread_finished) [[unlikely]] {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        registry.finished.values[site][event] += amount;
+        return;
+    }
+    auto& value = thread_counters.values[site][event];
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void instrument_snapshot(instrument_counters_t* counters) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    *counters = registry.finished;
+    for (const ThreadCounters* thread : registry.threads) {
+        thread->AddTo(counters);
+    }
+}
+
+void instrument_reset() {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.finished = {};
+    // Other threads may be counting at the same time, so some of their updates can survive
+    for (ThreadCounters* thread : registry.threads) {
+        for (auto& site : thread->values) {
+            for (auto& value : site) {
+                value.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void instrument_dump(FILE* out) {
+    instrument_counters_t counters;
+    instrument_snapshot(&counters);
+    for (size_t site = 0; site < INSTRUMENT_SITE_COUNT; ++site) {
+        const uint64_t* values = counters.values[site];
+        if (std::all_of(values, values + INSTRUMENT_EVENT_COUNT,
+                        [](uint64_t value) { return value == 0; })) {
+            continue;
+        }
+        fprintf(out, "{\"site\": \"%s\"", kSiteNames[site]);
+        for (size_t event = 0; event < INSTRUMENT_EVENT_COUNT; ++event) {
+            fprintf(out, ", \"%s\": %llu", kEventNames[event],
+                    static_cast<unsigned long long>(values[event]));
+        }
+        fprintf(out, "}\n");
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Counters of heap and reference count traffic for the other modules, shared by the C++
+// headers and the C collector. Compiled in only with CODE_EXAMPLES_INSTRUMENTATION defined
+// (the CMake option of the same name, which also builds instrumentation.cpp); otherwise every
+// INSTRUMENT_* macro expands to nothing.
+//
+// Each thread counts into its own counters without synchronization; `instrument_snapshot`
+// sums the counters of running threads with those left by finished ones.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    INSTRUMENT_SITE_MAKE_SHARED,        // `MakeShared`
+    INSTRUMENT_SITE_ALLOCATE_SHARED,    // `AllocateShared`
+    INSTRUMENT_SITE_SHARED_PTR_BLOCK,   // control blocks of `SharedPtr(Y*)` and `Reset(Y*)`
+    INSTRUMENT_SITE_SHARED_PTR_REFS,    // `SharedPtr` use count changes
+    INSTRUMENT_SITE_COW_VECTOR_STATE,   // `COWVector` states and their copies on write
+    INSTRUMENT_SITE_COW_VECTOR_CHUNK,   // `COWVector` chunks and their copies on write
+    INSTRUMENT_SITE_GC_MALLOC,          // `gc_malloc`
+    INSTRUMENT_SITE_COUNT
+} instrument_site_t;
+
+typedef enum {
+    INSTRUMENT_EVENT_ALLOCATIONS,
+    INSTRUMENT_EVENT_BYTES,
+    INSTRUMENT_EVENT_COPIES_ON_WRITE,
+    INSTRUMENT_EVENT_REF_COUNT_OPS,
+    INSTRUMENT_EVENT_COUNT
+} instrument_event_t;
+
+typedef struct {
+    uint64_t values[INSTRUMENT_SITE_COUNT][INSTRUMENT_EVENT_COUNT];
+} instrument_counters_t;
+
+#ifdef CODE_EXAMPLES_INSTRUMENTATION
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void instrument_record(instrument_site_t site, instrument_event_t event, uint64_t amount);
+
+// Totals over all threads since start or the last `instrument_reset`
+void instrument_snapshot(instrument_counters_t* counters);
+
+void instrument_reset(void);
+
+// Prints the non-zero totals as one JSON object per line
+void instrument_dump(FILE* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define INSTRUMENT(site, event, amount) \
+    instrument_record(INSTRUMENT_SITE_##site, INSTRUMENT_EVENT_##event, (amount))
+
+#else
+
+#define INSTRUMENT(site, event, amount) ((void)0)
+
+#endif
+
+#define INSTRUMENT_ALLOCATION(site, bytes) \
+    (INSTRUMENT(site, ALLOCATIONS, 1), INSTRUMENT(site, BYTES, (bytes)))
+#define INSTRUMENT_COPY_ON_WRITE(site) INSTRUMENT(site, COPIES_ON_WRITE, 1)
+#define INSTRUMENT_REF_COUNT(site) INSTRUMENT(site, REF_COUNT_OPS, 1)
@@ -0,0 +1,83 @@
+#include <instrumentation.h>
+
+#include <cow_vector.h>
+#include <shared.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace {
+
+uint64_t Count(const instrument_counters_t& counters, instrument_site_t site,
+               instrument_event_t event) {
+    return counters.values[site][event];
+}
+
+instrument_counters_t Snapshot() {
+    instrument_counters_t counters;
+    instrument_snapshot(&counters);
+    return counters;
+}
+
+}  // namespace
+
+TEST(Instrumentation, CountsMakeSharedAndRefCounts) {
+    instrument_reset();
+    {
+        SharedPtr<int> first = MakeShared<int>(1);
+        SharedPtr<int> second = first;
+        SharedPtr<std::string> third(new std::string("block"));
+    }
+    instrument_counters_t counters = Snapshot();
+    EXPECT_EQ(Count(counters, INSTRUMENT_SITE_MAKE_SHARED, INSTRUMENT_EVENT_ALLOCATIONS), 1u);
+    EXPECT_GT(Count(counters, INSTRUMENT_SITE_MAKE_SHARED, INSTRUMENT_EVENT_BYTES), sizeof(int));
+    EXPECT_EQ(Count(counters, INSTRUMENT_SITE_SHARED_PTR_BLOCK, INSTRUMENT_EVENT_ALLOCATIONS),
+              1u);
+    EXPECT_GT(Count(counters, INSTRUMENT_SITE_SHARED_PTR_REFS, INSTRUMENT_EVENT_REF_COUNT_OPS),
+              0u);
+}
+
+TEST(Instrumentation, CountsCopiesOnWrite) {
+    COWVector<int> vector;
+    for (int i = 0; i < 200; ++i) {
+        vector.PushBack(i);
+    }
+    instrument_reset();
+    COWVector<int> copy = vector;
+    copy.Set(0, -1);
+    copy.Set(1, -1);
+    instrument_counters_t counters = Snapshot();
+    // One state clone and one chunk clone; the second write hits the already private chunk
+    EXPECT_EQ(Count(counters, INSTRUMENT_SITE_COW_VECTOR_STATE, INSTRUMENT_EVENT_COPIES_ON_WRITE),
+              1u);
+    EXPECT_EQ(Count(counters, INSTRUMENT_SITE_COW_VECTOR_CHUNK, INSTRUMENT_EVENT_COPIES_ON_WRITE),
+              1u);
+}
+
+TEST(Instrumentation, AggregatesFinishedThreads) {
+    instrument_reset();
+    std::thread([] {
+        for (int i = 0; i < 10; ++i) {
+            MakeShared<int>(i);
+        }
+    }).join();
+    MakeShared<int>(0);
+    instrument_counters_t counters = Snapshot();
+    EXPECT_EQ(Count(counters, INSTRUMENT_SITE_MAKE_SHARED, INSTRUMENT_EVENT_ALLOCATIONS), 11u);
+}
+
+TEST(Instrumentation, DumpsJsonLines) {
+    instrument_reset();
+    MakeShared<int>(0);
+    char buffer[4096] = {};
+    FILE* out = fmemopen(buffer, sizeof(buffer) - 1, "w");
+    ASSERT_NE(out, nullptr);
+    instrument_dump(out);
+    std::fclose(out);
+    std::string dump(buffer);
+    EXPECT_NE(dump.find("make_shared"), std::string::npos) << dump;
+    EXPECT_EQ(dump.back(), '\n');
+}
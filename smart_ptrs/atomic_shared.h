@@ -0,0 +1,184 @@
+#pragma once
+
+#include "shared.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+// `SharedPtr` that can be read and replaced from many threads at once without a lock.
+//
+// The current value lives in a heap node whose address is packed together with a 16-bit
+// "local" counter into one atomic word (split reference count). A reader bumps the local
+// counter with a single `fetch_add`, copies the `SharedPtr` out of the node and then takes its
+// unit back. A writer that swaps the node out moves all outstanding local units into the
+// node's own counter, so the node stays alive until the last reader that saw it is done.
+// Readers never wait for writers and never touch a node that may already be freed.
+//
+// Requires user-space addresses to fit in 48 bits and at most 65535 readers inside `Load` at
+// the same time.
+template <typename T>
+class AtomicSharedPtr {
+private:
+    struct Node {
+        // The stored reference counts as `kStoredRef` so that readers dropping their units
+        // before the writer has credited them can never take the counter down to zero.
+        std::atomic<ptrdiff_t> refs_;
+        SharedPtr<T> value_;
+
+        explicit Node(SharedPtr<T> value) : refs_(kStoredRef), value_(std::move(value)) {
+        }
+    };
+
+    static_assert(sizeof(void*) == sizeof(uint64_t), "AtomicSharedPtr needs 64-bit pointers");
+
+    static constexpr int kLocalShift = 48;
+    static constexpr uint64_t kOneLocal = uint64_t(1) << kLocalShift;
+    static constexpr uint64_t kPointerMask = kOneLocal - 1;
+    static constexpr ptrdiff_t kStoredRef = ptrdiff_t(1) << 16;
+
+    std::atomic<uint64_t> word_;
+
+    static Node* NodeOf(uint64_t word) {
+        return reinterpret_cast<Node*>(word & kPointerMask);
+    }
+
+    static ptrdiff_t LocalsOf(uint64_t word) {
+        return static_cast<ptrdiff_t>(word >> kLocalShift);
+    }
+
+    static uint64_t Pack(Node* node) {
+        return reinterpret_cast<uint64_t>(node);
+    }
+
+    static bool IsEmpty(const SharedPtr<T>& ptr) {
+        return ptr.managed_ptr_ == nullptr && ptr.ptr_ == nullptr;
+    }
+
+    static Node* MakeNode(SharedPtr<T> value) {
+        if (IsEmpty(value)) {
+            return nullptr;
+        }
+        return new Node(std::move(value));
+    }
+
+    static void DropRefs(Node* node, ptrdiff_t count) {
+        if (node->refs_.fetch_sub(count, std::memory_order_acq_rel) == count) {
+            delete node;
+        }
+    }
+
+    // Called by whoever swapped `node` out of `word_`: credits the `locals` units that
+    // readers still hold and gives up the stored reference.
+    static void Retire(Node* node, ptrdiff_t locals) {
+        if (node != nullptr) {
+            DropRefs(node, kStoredRef - locals);
+        }
+    }
+
+    // Returns the local unit taken by `AcquireLocal`. If the node has been swapped out in the
+    // meantime, the unit was already moved into the node's counter and is dropped there.
+    void ReleaseLocal(Node* node) {
+        uint64_t cur = word_.load(std::memory_order_relaxed);
+        while (NodeOf(cur) == node && LocalsOf(cur) > 0) {
+            if (word_.compare_exchange_weak(cur, cur - kOneLocal, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        if (node != nullptr) {
+            DropRefs(node, 1);
+        }
+    }
+
+    Node* AcquireLocal() {
+        return NodeOf(word_.fetch_add(kOneLocal, std::memory_order_acquire));
+    }
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    AtomicSharedPtr() : word_(0) {
+    }
+
+    AtomicSharedPtr(SharedPtr<T> value) : word_(Pack(MakeNode(std::move(value)))) {
+    }
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~AtomicSharedPtr() {
+        uint64_t word = word_.load(std::memory_order_acquire);
+        Retire(NodeOf(word), LocalsOf(word));
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Atomic operations
+
+    SharedPtr<T> Load() {
+        if (NodeOf(word_.load(std::memory_order_acquire)) == nullptr) {
+            return SharedPtr<T>();
+        }
+        Node* node = AcquireLocal();
+        SharedPtr<T> result;
+        if (node != nullptr) {
+            result = node->value_;
+        }
+        ReleaseLocal(node);
+        return result;
+    }
+
+    void Store(SharedPtr<T> desired) {
+        uint64_t old = word_.exchange(Pack(MakeNode(std::move(desired))), std::memory_order_acq_rel);
+        Retire(NodeOf(old), LocalsOf(old));
+    }
+
+    SharedPtr<T> Exchange(SharedPtr<T> desired) {
+        uint64_t old = word_.exchange(Pack(MakeNode(std::move(desired))), std::memory_order_acq_rel);
+        Node* node = NodeOf(old);
+        SharedPtr<T> result;
+        if (node != nullptr) {
+            // Readers may still be copying `value_`, so it is copied rather than moved out
+            result = node->value_;
+        }
+        Retire(node, LocalsOf(old));
+        return result;
+    }
+
+    // Replaces the value with `desired` if it still shares both the control block and the
+    // pointer with `expected`. Otherwise loads the current value into `expected`.
+    bool CompareExchange(SharedPtr<T>& expected, SharedPtr<T> desired) {
+        Node* new_node = MakeNode(std::move(desired));
+        while (true) {
+            Node* node = AcquireLocal();
+            bool same = node == nullptr ? IsEmpty(expected)
+                                        : node->value_.managed_ptr_ == expected.managed_ptr_ &&
+                                              node->value_.ptr_ == expected.ptr_;
+            if (!same) {
+                expected = node == nullptr ? SharedPtr<T>() : node->value_;
+                ReleaseLocal(node);
+                delete new_node;
+                return false;
+            }
+            uint64_t cur = word_.load(std::memory_order_relaxed);
+            while (NodeOf(cur) == node) {
+                if (word_.compare_exchange_weak(cur, Pack(new_node), std::memory_order_acq_rel,
+                                                std::memory_order_relaxed)) {
+                    // One of the swapped-out units is ours and is simply not credited
+                    Retire(node, LocalsOf(cur) - 1);
+                    return true;
+                }
+            }
+            ReleaseLocal(node);
+        }
+    }
+
+    static constexpr bool IsLockFree() {
+        return true;
+    }
+};
@@ -0,0 +1,63 @@
+#include <atomic_shared.h>
+#include <benchmark.h>
+#include <shared.h>
+
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Config {
+    int64_t values[8] = {};
+};
+
+// `threads` readers each load the current snapshot `iterations / threads` times
+template <class Load>
+void ReadersLoad(size_t iterations, int threads, Load load) {
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threads; ++t) {
+        size_t count = iterations / threads + (static_cast<size_t>(t) < iterations % threads);
+        readers.emplace_back([&load, count] {
+            for (size_t i = 0; i < count; ++i) {
+                SharedPtr<Config> config = load();
+                DoNotOptimize(config->values[0]);
+            }
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+}
+
+// Read scaling across cores: the mutex serializes every reader on one cache line and one
+// lock, `AtomicSharedPtr` readers only share a counter word
+[[maybe_unused]] const bool kReadScalingRegistered = [] {
+    for (int threads : {1, 2, 4, 8}) {
+        std::string suffix = "/threads:" + std::to_string(threads);
+        RegisterBenchmark("AtomicSharedPtrLoad" + suffix, [threads](size_t iterations) {
+            AtomicSharedPtr<Config> current(MakeShared<Config>());
+            ReadersLoad(iterations, threads, [&current] { return current.Load(); });
+        });
+        RegisterBenchmark("MutexSharedPtrLoad" + suffix, [threads](size_t iterations) {
+            std::mutex mutex;
+            SharedPtr<Config> current = MakeShared<Config>();
+            ReadersLoad(iterations, threads, [&] {
+                std::lock_guard<std::mutex> lock(mutex);
+                return current;
+            });
+        });
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK(AtomicSharedPtrStore) {
+    AtomicSharedPtr<Config> current(MakeShared<Config>());
+    SharedPtr<Config> next = MakeShared<Config>();
+    for (size_t i = 0; i < iterations; ++i) {
+        current.Store(next);
+    }
+}
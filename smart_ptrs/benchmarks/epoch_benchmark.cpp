@@ -0,0 +1,124 @@
+#include <benchmark.h>
+#include <epoch.h>
+#include <unique.h>
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Node {
+    int64_t value;
+    Node* next;
+};
+
+// Treiber stack whose popped nodes go to the epoch domain through `RetireDeleter`
+class EpochStack {
+public:
+    ~EpochStack() {
+        while (Node* node = head_.load()) {
+            head_.store(node->next);
+            delete node;
+        }
+    }
+
+    void Push(int64_t value) {
+        auto* node = new Node{value, head_.load(std::memory_order_relaxed)};
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Pop(int64_t* value) {
+        EpochGuard guard;
+        Node* node = head_.load(std::memory_order_acquire);
+        while (node != nullptr && !head_.compare_exchange_weak(node, node->next,
+                                                               std::memory_order_acquire,
+                                                               std::memory_order_acquire)) {
+        }
+        if (node == nullptr) {
+            return false;
+        }
+        *value = node->value;
+        UniquePtr<Node, RetireDeleter<Node>> retired(node);
+        return true;
+    }
+
+private:
+    std::atomic<Node*> head_ = nullptr;
+};
+
+class MutexStack {
+public:
+    void Push(int64_t value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        values_.push_back(value);
+    }
+
+    bool Pop(int64_t* value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (values_.empty()) {
+            return false;
+        }
+        *value = values_.back();
+        values_.pop_back();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<int64_t> values_;
+};
+
+// Every thread pushes and pops in turn; one operation is a push and a pop
+template <class Stack>
+void PushPop(size_t iterations, int threads) {
+    Stack stack;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        size_t count = iterations / threads + (static_cast<size_t>(t) < iterations % threads);
+        workers.emplace_back([&stack, count] {
+            int64_t value = 0;
+            for (size_t i = 0; i < count; ++i) {
+                stack.Push(static_cast<int64_t>(i));
+                stack.Pop(&value);
+            }
+            DoNotOptimize(value);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+[[maybe_unused]] const bool kStackRegistered = [] {
+    for (int threads : {1, 2, 4}) {
+        std::string suffix = "/threads:" + std::to_string(threads);
+        RegisterBenchmark("EpochStackPushPop" + suffix, [threads](size_t iterations) {
+            PushPop<EpochStack>(iterations, threads);
+        });
+        RegisterBenchmark("MutexStackPushPop" + suffix, [threads](size_t iterations) {
+            PushPop<MutexStack>(iterations, threads);
+        });
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK(EpochGuard) {
+    for (size_t i = 0; i < iterations; ++i) {
+        EpochGuard guard;
+        ClobberMemory();
+    }
+}
+
+BENCHMARK(EpochRetire) {
+    for (size_t i = 0; i < iterations; ++i) {
+        UniquePtr<Node, RetireDeleter<Node>> node(new Node{static_cast<int64_t>(i), nullptr});
+    }
+    EpochDomain::Instance().Collect();
+}
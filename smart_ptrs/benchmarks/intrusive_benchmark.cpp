@@ -0,0 +1,130 @@
+#include <benchmark.h>
+#include <intrusive.h>
+#include <shared.h>
+
+#include <vector>
+
+namespace {
+
+constexpr int kDepth = 14;
+
+struct Payload {
+    int64_t values[4] = {};
+};
+
+struct Node : RefCounted<Node> {
+    Payload payload;
+};
+
+// Binary trees whose children are held by the pointer under test
+template <class Counter>
+struct IntrusiveTree : RefCounted<IntrusiveTree<Counter>, Counter> {
+    IntrusivePtr<IntrusiveTree> left;
+    IntrusivePtr<IntrusiveTree> right;
+    int64_t value = 0;
+};
+
+struct SharedTree {
+    SharedPtr<SharedTree> left;
+    SharedPtr<SharedTree> right;
+    int64_t value = 0;
+};
+
+template <class Counter>
+IntrusivePtr<IntrusiveTree<Counter>> BuildIntrusive(int depth, int64_t& next) {
+    auto node = MakeIntrusive<IntrusiveTree<Counter>>();
+    node->value = next++;
+    if (depth > 0) {
+        node->left = BuildIntrusive<Counter>(depth - 1, next);
+        node->right = BuildIntrusive<Counter>(depth - 1, next);
+    }
+    return node;
+}
+
+SharedPtr<SharedTree> BuildShared(int depth, int64_t& next) {
+    auto node = MakeShared<SharedTree>();
+    node->value = next++;
+    if (depth > 0) {
+        node->left = BuildShared(depth - 1, next);
+        node->right = BuildShared(depth - 1, next);
+    }
+    return node;
+}
+
+// Depth-first walk over an explicit stack of owning pointers, the way a visitor that keeps
+// the nodes alive while it works copies them; the time is per visited node
+template <class Pointer>
+void Traverse(size_t iterations, const Pointer& root) {
+    std::vector<Pointer> stack;
+    int64_t sum = 0;
+    size_t visited = 0;
+    while (visited < iterations) {
+        stack.push_back(root);
+        while (!stack.empty() && visited < iterations) {
+            Pointer node = std::move(stack.back());
+            stack.pop_back();
+            sum += node->value;
+            ++visited;
+            if (node->left) {
+                stack.push_back(node->left);
+                stack.push_back(node->right);
+            }
+        }
+        stack.clear();
+    }
+    DoNotOptimize(sum);
+}
+
+// Building and dropping a whole tree; the time is per node
+template <class Build>
+void BuildAndDrop(size_t iterations, Build build) {
+    size_t nodes = (size_t(1) << (kDepth + 1)) - 1;
+    for (size_t done = 0; done < iterations; done += nodes) {
+        int64_t next = 0;
+        DoNotOptimize(build(next).Get());
+    }
+}
+
+}  // namespace
+
+BENCHMARK(IntrusivePtrCopy) {
+    IntrusivePtr<Node> pointer = MakeIntrusive<Node>();
+    for (size_t i = 0; i < iterations; ++i) {
+        IntrusivePtr<Node> copy = pointer;
+        DoNotOptimize(copy.Get());
+    }
+}
+
+// The trees are built once, outside the measured walks
+BENCHMARK(IntrusiveTreeTraverse) {
+    static const auto root = [] {
+        int64_t next = 0;
+        return BuildIntrusive<AtomicRefCount>(kDepth, next);
+    }();
+    Traverse(iterations, root);
+}
+
+BENCHMARK(IntrusiveSimpleTreeTraverse) {
+    static const auto root = [] {
+        int64_t next = 0;
+        return BuildIntrusive<SimpleRefCount>(kDepth, next);
+    }();
+    Traverse(iterations, root);
+}
+
+BENCHMARK(SharedTreeTraverse) {
+    static const auto root = [] {
+        int64_t next = 0;
+        return BuildShared(kDepth, next);
+    }();
+    Traverse(iterations, root);
+}
+
+BENCHMARK(IntrusiveTreeBuild) {
+    BuildAndDrop(iterations,
+                 [](int64_t& next) { return BuildIntrusive<AtomicRefCount>(kDepth, next); });
+}
+
+BENCHMARK(SharedTreeBuild) {
+    BuildAndDrop(iterations, [](int64_t& next) { return BuildShared(kDepth, next); });
+}
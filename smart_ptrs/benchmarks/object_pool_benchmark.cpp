@@ -0,0 +1,62 @@
+#include <benchmark.h>
+#include <object_pool.h>
+#include <unique.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kLiveObjects = 4096;
+
+struct Payload {
+    int64_t values[8] = {};
+};
+
+// Every thread keeps `kLiveObjects` objects alive and replaces one of them per iteration, in
+// an order that scatters frees over the working set
+template <class Pointer, class Make>
+void Churn(size_t iterations, int threads, Make make) {
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        size_t count = iterations / threads + (static_cast<size_t>(t) < iterations % threads);
+        workers.emplace_back([&make, count] {
+            std::vector<Pointer> live;
+            for (size_t i = 0; i < kLiveObjects; ++i) {
+                live.push_back(make());
+            }
+            for (size_t i = 0; i < count; ++i) {
+                Pointer& slot = live[(i * 2654435761u) % kLiveObjects];
+                slot = make();
+                DoNotOptimize(slot.Get());
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+[[maybe_unused]] const bool kChurnRegistered = [] {
+    for (int threads : {1, 2, 4}) {
+        std::string suffix = "/threads:" + std::to_string(threads);
+        RegisterBenchmark("PooledChurn" + suffix, [threads](size_t iterations) {
+            Churn<PooledPtr<Payload>>(iterations, threads, [] { return MakePooled<Payload>(); });
+        });
+        RegisterBenchmark("NewDeleteChurn" + suffix, [threads](size_t iterations) {
+            Churn<UniquePtr<Payload>>(iterations, threads,
+                                      [] { return UniquePtr<Payload>(new Payload()); });
+        });
+    }
+    return true;
+}();
+
+}  // namespace
+
+BENCHMARK(MakePooled) {
+    for (size_t i = 0; i < iterations; ++i) {
+        PooledPtr<Payload> pointer = MakePooled<Payload>();
+        DoNotOptimize(pointer.Get());
+    }
+}
@@ -0,0 +1,54 @@
+#include <benchmark.h>
+#include <pool_allocator.h>
+#include <shared.h>
+
+namespace {
+
+struct Payload {
+    int64_t values[4] = {};
+};
+
+}  // namespace
+
+// Adopting a pointer: the control block from the global heap or from the pool
+
+BENCHMARK(SharedPtrFromNew) {
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> pointer(new Payload());
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(SharedPtrFromNewPool) {
+    PoolAllocator<Payload> alloc;
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> pointer(new Payload(), alloc);
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(SharedPtrResetFromNew) {
+    SharedPtr<Payload> pointer;
+    for (size_t i = 0; i < iterations; ++i) {
+        pointer.Reset(new Payload());
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(SharedPtrResetFromNewPool) {
+    PoolAllocator<Payload> alloc;
+    SharedPtr<Payload> pointer;
+    for (size_t i = 0; i < iterations; ++i) {
+        pointer.Reset(new Payload(), alloc);
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+// Block and object in one allocation, against `MakeShared` in smart_ptrs_benchmark.cpp
+BENCHMARK(AllocateSharedPool) {
+    PoolAllocator<Payload> alloc;
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> pointer = AllocateShared<Payload>(alloc);
+        DoNotOptimize(pointer.Get());
+    }
+}
@@ -0,0 +1,57 @@
+#include <benchmark.h>
+#include <shared.h>
+#include <unique.h>
+
+#include <memory>
+
+namespace {
+
+struct Payload {
+    int64_t values[4] = {};
+};
+
+}  // namespace
+
+BENCHMARK(MakeShared) {
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> pointer = MakeShared<Payload>();
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(StdMakeShared) {
+    for (size_t i = 0; i < iterations; ++i) {
+        std::shared_ptr<Payload> pointer = std::make_shared<Payload>();
+        DoNotOptimize(pointer.get());
+    }
+}
+
+BENCHMARK(SharedPtrCopy) {
+    SharedPtr<Payload> pointer = MakeShared<Payload>();
+    for (size_t i = 0; i < iterations; ++i) {
+        SharedPtr<Payload> copy = pointer;
+        DoNotOptimize(copy.Get());
+    }
+}
+
+BENCHMARK(StdSharedPtrCopy) {
+    std::shared_ptr<Payload> pointer = std::make_shared<Payload>();
+    for (size_t i = 0; i < iterations; ++i) {
+        std::shared_ptr<Payload> copy = pointer;
+        DoNotOptimize(copy.get());
+    }
+}
+
+BENCHMARK(UniquePtrNew) {
+    for (size_t i = 0; i < iterations; ++i) {
+        UniquePtr<Payload> pointer(new Payload());
+        DoNotOptimize(pointer.Get());
+    }
+}
+
+BENCHMARK(StdUniquePtrNew) {
+    for (size_t i = 0; i < iterations; ++i) {
+        std::unique_ptr<Payload> pointer(new Payload());
+        DoNotOptimize(pointer.get());
+    }
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Epoch-based reclamation for lock-free structures.
+//
+// Readers wrap every access to shared nodes in an `EpochGuard`. A node unlinked by a writer is
+// handed to `Retire` instead of being freed; it is destroyed only after the global epoch has
+// moved two steps forward, at which point no reader that could have seen it is still inside
+// its guard. Each thread keeps its retired nodes in three lists (one per epoch mod 3) and tries
+// to advance the epoch once every `kBatchSize` retirements, so reclamation happens in batches.
+class EpochDomain {
+public:
+    static constexpr size_t kBatchSize = 64;
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    // Never destroyed, see the definition
+    static EpochDomain& Instance();
+
+    // Guards may nest; only the outermost pair announces the epoch
+    void Enter();
+    void Leave();
+
+    template <typename T>
+    void Retire(T* ptr) {
+        Retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+    }
+
+    void Retire(void* ptr, void (*deleter)(void*));
+
+    // Tries to advance the epoch and frees everything the calling thread may free
+    void Collect();
+
+private:
+    struct Retired {
+        void* ptr;
+        void (*deleter)(void*);
+    };
+
+    // Records are never freed: a thread that exits gives its record (with whatever is still
+    // retired in it) to the next thread that arrives.
+    struct ThreadRecord {
+        // `(epoch << 1) | 1` while inside a guard, 0 otherwise
+        std::atomic<uint64_t> announced = 0;
+        std::atomic<bool> in_use = true;
+        ThreadRecord* next = nullptr;
+
+        size_t nesting = 0;
+        size_t retired_since_collect = 0;
+        std::vector<Retired> limbo[3];
+        uint64_t limbo_epoch[3] = {0, 0, 0};
+    };
+
+    struct RecordHolder {
+        ThreadRecord* record = nullptr;
+
+        ~RecordHolder() {
+            if (record != nullptr) {
+                record->in_use.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    std::atomic<uint64_t> global_epoch_ = 0;
+    std::atomic<ThreadRecord*> records_ = nullptr;
+
+    EpochDomain() = default;
+
+    ThreadRecord* LocalRecord();
+    ThreadRecord* AcquireRecord();
+    bool TryAdvance();
+    static void FreeList(std::vector<Retired>& list);
+};
+
+// RAII pin of the calling thread to the current epoch
+class EpochGuard {
+public:
+    EpochGuard() {
+        EpochDomain::Instance().Enter();
+    }
+
+    EpochGuard(const EpochGuard&) = delete;
+    EpochGuard& operator=(const EpochGuard&) = delete;
+
+    ~EpochGuard() {
+        EpochDomain::Instance().Leave();
+    }
+};
+
+// Stateless deleter deferring destruction to `EpochDomain`:
+// `UniquePtr<Node, RetireDeleter<Node>>` stays one pointer wide and retires on `Reset`.
+template <typename T>
+struct RetireDeleter {
+    RetireDeleter() {
+    }
+
+    template <typename U>
+    RetireDeleter(U&&) {
+    }
+
+    void operator()(T* ptr) {
+        EpochDomain::Instance().Retire(ptr);
+    }
+};
+
+// The domain is leaked on purpose, like `FixedSizePool`: static and thread-local objects may
+// retire nodes or take guards from their destructors, which run at exit in no order relative
+// to a function-local static. Nodes still retired at exit are not freed.
+inline EpochDomain& EpochDomain::Instance() {
+    static EpochDomain* domain = new EpochDomain();
+    return *domain;
+}
+
+inline void EpochDomain::Enter() {
+    ThreadRecord* record = LocalRecord();
+    if (record->nesting++ == 0) {
+        uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+        record->announced.store((epoch << 1) | 1, std::memory_order_relaxed);
+        // The announcement must be visible before any shared node is read
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+}
+
+inline void EpochDomain::Leave() {
+    ThreadRecord* record = LocalRecord();
+    if (--record->nesting == 0) {
+        record->announced.store(0, std::memory_order_release);
+    }
+}
+
+inline void EpochDomain::Retire(void* ptr, void (*deleter)(void*)) {
+    if (ptr == nullptr) {
+        return;
+    }
+    ThreadRecord* record = LocalRecord();
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    size_t slot = epoch % 3;
+    if (record->limbo_epoch[slot] != epoch) {
+        // The slot holds nodes from at least three epochs ago
+        record->limbo_epoch[slot] = epoch;
+        FreeList(record->limbo[slot]);
+    }
+    record->limbo[slot].push_back({ptr, deleter});
+    if (++record->retired_since_collect >= kBatchSize) {
+        Collect();
+    }
+}
+
+inline void EpochDomain::Collect() {
+    ThreadRecord* record = LocalRecord();
+    record->retired_since_collect = 0;
+    TryAdvance();
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    for (size_t slot = 0; slot < 3; ++slot) {
+        if (record->limbo_epoch[slot] + 2 <= epoch) {
+            FreeList(record->limbo[slot]);
+        }
+    }
+}
+
+inline bool EpochDomain::TryAdvance() {
+    uint64_t epoch = global_epoch_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr;
+         record = record->next) {
+        uint64_t announced = record->announced.load(std::memory_order_acquire);
+        if ((announced & 1) != 0 && (announced >> 1) != epoch) {
+            return false;
+        }
+    }
+    return global_epoch_.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+}
+
+inline EpochDomain::ThreadRecord* EpochDomain::LocalRecord() {
+    static thread_local RecordHolder holder;
+    if (holder.record == nullptr) {
+        holder.record = AcquireRecord();
+    }
+    return holder.record;
+}
+
+inline EpochDomain::ThreadRecord* EpochDomain::AcquireRecord() {
+    for (ThreadRecord* record = records_.load(std::memory_order_acquire); record != nullptr;
+         record = record->next) {
+        bool expected = false;
+        if (record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+    auto record = new ThreadRecord();
+    ThreadRecord* head = records_.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records_.compare_exchange_weak(head, record, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    return record;
+}
+
+inline void EpochDomain::FreeList(std::vector<Retired>& list) {
+    // Deleters may retire more nodes into `list`, so it is emptied before they run
+    std::vector<Retired> expired;
+    expired.swap(list);
+    for (const Retired& retired : expired) {
+        retired.deleter(retired.ptr);
+    }
+    if (list.empty()) {
+        expired.clear();
+        list.swap(expired);
+    }
+}
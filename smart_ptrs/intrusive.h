@@ -0,0 +1,249 @@
+#pragma once
+
+#include "unique.h"
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Counter policies for `RefCounted`
+
+class AtomicRefCount {
+public:
+    void Increment() {
+        count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Returns true when the last reference is gone
+    bool Decrement() {
+        return count_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    size_t Get() const {
+        return count_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> count_ = 0;
+};
+
+class SimpleRefCount {
+public:
+    void Increment() {
+        ++count_;
+    }
+
+    bool Decrement() {
+        return --count_ == 0;
+    }
+
+    size_t Get() const {
+        return count_;
+    }
+
+private:
+    size_t count_ = 0;
+};
+
+// Embeddable counter: `class Node : public RefCounted<Node> {...}`. No vtable is added and the
+// counter sits right next to the object's own fields.
+//
+// Any other type can be used with `IntrusivePtr` by providing `IntrusivePtrAddRef(const T*)`
+// and `IntrusivePtrRelease(const T*)` findable by ADL.
+template <typename Derived, typename Counter = AtomicRefCount>
+class RefCounted {
+private:
+    mutable Counter ref_count_;
+
+    friend void IntrusivePtrAddRef(const Derived* ptr) {
+        static_cast<const RefCounted*>(ptr)->ref_count_.Increment();
+    }
+
+    friend void IntrusivePtrRelease(const Derived* ptr) {
+        if (static_cast<const RefCounted*>(ptr)->ref_count_.Decrement()) {
+            delete ptr;
+        }
+    }
+
+    friend size_t IntrusivePtrUseCount(const Derived* ptr) {
+        return static_cast<const RefCounted*>(ptr)->ref_count_.Get();
+    }
+
+protected:
+    RefCounted() = default;
+
+    // Copies of an object start with their own zero count
+    RefCounted(const RefCounted&) {
+    }
+
+    RefCounted& operator=(const RefCounted&) {
+        return *this;
+    }
+
+    ~RefCounted() = default;
+};
+
+template <typename T>
+class IntrusivePtr {
+private:
+    T* ptr_;
+
+    template <typename Y>
+    friend class IntrusivePtr;
+
+public:
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Constructors
+
+    IntrusivePtr();
+    IntrusivePtr(std::nullptr_t);
+
+    // `add_ref = false` adopts a reference the caller already owns (see `Detach`)
+    explicit IntrusivePtr(T* ptr, bool add_ref = true);
+
+    IntrusivePtr(const IntrusivePtr& other);
+    IntrusivePtr(IntrusivePtr&& other);
+
+    template <typename Y>
+    IntrusivePtr(const IntrusivePtr<Y>& other) : IntrusivePtr(other.ptr_) {
+    }
+
+    template <typename Y>
+    IntrusivePtr(IntrusivePtr<Y>&& other) : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    // Takes over an object owned by a `UniquePtr` with the default deleter
+    template <typename Y>
+    IntrusivePtr(UniquePtr<Y>&& other) : IntrusivePtr(other.Release()) {
+    }
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // `operator=`-s
+
+    IntrusivePtr& operator=(const IntrusivePtr& other);
+    IntrusivePtr& operator=(IntrusivePtr&& other);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Destructor
+
+    ~IntrusivePtr();
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Modifiers
+
+    void Reset(T* ptr = nullptr);
+    void Swap(IntrusivePtr& other);
+
+    // Gives up ownership without dropping the reference
+    T* Detach();
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////
+    // Observers
+
+    T* Get() const;
+    T& operator*() const;
+    T* operator->() const;
+    size_t UseCount() const;
+    explicit operator bool() const;
+};
+
+template <typename T, typename U>
+inline bool operator==(const IntrusivePtr<T>& left, const IntrusivePtr<U>& right) {
+    return left.Get() == right.Get();
+}
+
+template <typename T, typename... Args>
+IntrusivePtr<T> MakeIntrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
+
+static_assert(sizeof(IntrusivePtr<int>) == sizeof(int*));
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr() : ptr_(nullptr) {
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(std::nullptr_t) : ptr_(nullptr) {
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(T* ptr, bool add_ref) : ptr_(ptr) {
+    if (ptr_ != nullptr && add_ref) {
+        IntrusivePtrAddRef(ptr_);
+    }
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(const IntrusivePtr& other) : IntrusivePtr(other.ptr_) {
+}
+
+template <typename T>
+IntrusivePtr<T>::IntrusivePtr(IntrusivePtr&& other) : ptr_(other.ptr_) {
+    other.ptr_ = nullptr;
+}
+
+template <typename T>
+IntrusivePtr<T>& IntrusivePtr<T>::operator=(const IntrusivePtr& other) {
+    IntrusivePtr(other).Swap(*this);
+    return *this;
+}
+
+template <typename T>
+IntrusivePtr<T>& IntrusivePtr<T>::operator=(IntrusivePtr&& other) {
+    IntrusivePtr(std::move(other)).Swap(*this);
+    return *this;
+}
+
+template <typename T>
+IntrusivePtr<T>::~IntrusivePtr() {
+    if (ptr_ != nullptr) {
+        IntrusivePtrRelease(ptr_);
+    }
+}
+
+template <typename T>
+void IntrusivePtr<T>::Reset(T* ptr) {
+    IntrusivePtr(ptr).Swap(*this);
+}
+
+template <typename T>
+void IntrusivePtr<T>::Swap(IntrusivePtr& other) {
+    std::swap(ptr_, other.ptr_);
+}
+
+template <typename T>
+T* IntrusivePtr<T>::Detach() {
+    T* ret = ptr_;
+    ptr_ = nullptr;
+    return ret;
+}
+
+template <typename T>
+T* IntrusivePtr<T>::Get() const {
+    return ptr_;
+}
+
+template <typename T>
+T& IntrusivePtr<T>::operator*() const {
+    return *ptr_;
+}
+
+template <typename T>
+T* IntrusivePtr<T>::operator->() const {
+    return ptr_;
+}
+
+template <typename T>
+size_t IntrusivePtr<T>::UseCount() const {
+    if (ptr_ != nullptr) {
+        return IntrusivePtrUseCount(ptr_);
+    }
+    return 0;
+}
+
+template <typename T>
+IntrusivePtr<T>::operator bool() const {
+    return ptr_ != nullptr;
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "unique.h"
+
+#include <concepts>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Optional reset hook. Objects of such types are kept constructed while they sit in the pool
+// and are handed out again after `ResetForReuse()`, skipping the destructor/constructor pair.
+template <typename T>
+concept PoolResettable = requires(T& object) {
+    { object.ResetForReuse() } -> std::same_as<void>;
+};
+
+// Per-type pool of recycled objects. Each thread caches up to `kMaxCachedPerThread` slots of
+// its own, so neither `Acquire` nor `Recycle` synchronizes with other threads. An object may
+// be recycled on a thread other than the one that acquired it, and also after the thread's
+// cache is gone, e.g. from the destructor of a static `PooledPtr`: it is then freed directly.
+template <typename T>
+class ObjectPool {
+public:
+    static constexpr size_t kMaxCachedPerThread = 1024;
+
+    template <typename... Args>
+    static T* Acquire(Args&&... args);
+
+    static void Recycle(T* ptr);
+
+    // Number of slots cached by the calling thread
+    static size_t CachedCount();
+
+private:
+    struct ThreadCache {
+        std::vector<void*> slots;
+
+        // `Recycle` runs inside deleters and must not allocate
+        ThreadCache() {
+            slots.reserve(kMaxCachedPerThread);
+        }
+
+        ~ThreadCache() {
+            for (void* slot : slots) {
+                if constexpr (PoolResettable<T>) {
+                    static_cast<T*>(slot)->~T();
+                }
+                Deallocate(slot);
+            }
+            CacheDestroyed() = true;
+        }
+    };
+
+    static ThreadCache& LocalCache() {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Set once this thread's cache is gone; later calls allocate and free directly
+    static bool& CacheDestroyed() {
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    static void* Allocate() {
+        return ::operator new(sizeof(T), std::align_val_t(alignof(T)));
+    }
+
+    static void Deallocate(void* slot) {
+        ::operator delete(slot, std::align_val_t(alignof(T)));
+    }
+};
+
+// Stateless deleter returning objects to `ObjectPool<T>`. Thanks to `CompressedPair`,
+// `UniquePtr<T, PoolDeleter<T>>` stays one pointer wide.
+template <typename T>
+struct PoolDeleter {
+    PoolDeleter() {
+    }
+
+    template <typename U>
+    PoolDeleter(U&&) {
+    }
+
+    void operator()(T* ptr) {
+        ObjectPool<T>::Recycle(ptr);
+    }
+};
+
+template <typename T>
+using PooledPtr = UniquePtr<T, PoolDeleter<T>>;
+
+template <typename T, typename... Args>
+PooledPtr<T> MakePooled(Args&&... args) {
+    return PooledPtr<T>(ObjectPool<T>::Acquire(std::forward<Args>(args)...));
+}
+
+static_assert(sizeof(PooledPtr<int>) == sizeof(int*));
+
+template <typename T>
+template <typename... Args>
+T* ObjectPool<T>::Acquire(Args&&... args) {
+    if (CacheDestroyed() || LocalCache().slots.empty()) {
+        void* slot = Allocate();
+        try {
+            return new (slot) T(std::forward<Args>(args)...);
+        } catch (...) {
+            Deallocate(slot);
+            throw;
+        }
+    }
+    ThreadCache& cache = LocalCache();
+    void* slot = cache.slots.back();
+    cache.slots.pop_back();
+    if constexpr (PoolResettable<T>) {
+        if constexpr (sizeof...(Args) == 0) {
+            return static_cast<T*>(slot);
+        } else {
+            static_cast<T*>(slot)->~T();
+        }
+    }
+    try {
+        return new (slot) T(std::forward<Args>(args)...);
+    } catch (...) {
+        Deallocate(slot);
+        throw;
+    }
+}
+
+template <typename T>
+void ObjectPool<T>::Recycle(T* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    if (CacheDestroyed() || LocalCache().slots.size() == kMaxCachedPerThread) {
+        ptr->~T();
+        Deallocate(ptr);
+        return;
+    }
+    if constexpr (PoolResettable<T>) {
+        ptr->ResetForReuse();
+    } else {
+        ptr->~T();
+    }
+    LocalCache().slots.push_back(ptr);
+}
+
+template <typename T>
+size_t ObjectPool<T>::CachedCount() {
+    return CacheDestroyed() ? 0 : LocalCache().slots.size();
+}
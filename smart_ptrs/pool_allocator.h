@@ -0,0 +1,179 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+// Pool of equally sized blocks. Every thread owns a free list of its own and trades blocks
+// with the shared list in batches, so the usual `Allocate`/`Deallocate` never takes a lock.
+// The pool is never destroyed and never returns memory to the system, so blocks can still be
+// freed from destructors of static and thread-local objects that run at exit.
+template <std::size_t BlockSize, std::size_t Alignment>
+class FixedSizePool {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr std::size_t kAlignment = std::max(Alignment, alignof(FreeBlock));
+    static constexpr std::size_t kBlockSize =
+        (std::max(BlockSize, sizeof(FreeBlock)) + kAlignment - 1) / kAlignment * kAlignment;
+    static constexpr std::size_t kBatchSize = 64;
+    static constexpr std::size_t kBlocksPerChunk = 4 * kBatchSize;
+
+    struct ThreadCache {
+        FreeBlock* head = nullptr;
+        std::size_t size = 0;
+
+        ~ThreadCache() {
+            if (head != nullptr) {
+                FixedSizePool::Instance().PushBatch(head, size);
+            }
+            CacheDestroyed() = true;
+        }
+    };
+
+    std::mutex mutex_;
+    FreeBlock* head_ = nullptr;
+
+    FixedSizePool() = default;
+
+    static ThreadCache& LocalCache() {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Set once this thread's cache is gone; later calls go to the shared list directly
+    static bool& CacheDestroyed() {
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    // Adds a fresh chunk of blocks to the shared list; `mutex_` must be held
+    void Carve() {
+        char* chunk = static_cast<char*>(
+            ::operator new(kBlocksPerChunk * kBlockSize, std::align_val_t(kAlignment)));
+        for (std::size_t i = 0; i < kBlocksPerChunk; ++i) {
+            auto block = reinterpret_cast<FreeBlock*>(chunk + i * kBlockSize);
+            block->next = head_;
+            head_ = block;
+        }
+    }
+
+    void PushBatch(FreeBlock* first, std::size_t count) {
+        FreeBlock* last = first;
+        for (std::size_t i = 1; i < count; ++i) {
+            last = last->next;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        last->next = head_;
+        head_ = first;
+    }
+
+    // Moves up to `kBatchSize` blocks from the shared list into `cache`, carving a new chunk
+    // when the shared list is empty.
+    void Refill(ThreadCache& cache) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (head_ == nullptr) {
+            Carve();
+        }
+        while (head_ != nullptr && cache.size < kBatchSize) {
+            FreeBlock* block = head_;
+            head_ = block->next;
+            block->next = cache.head;
+            cache.head = block;
+            ++cache.size;
+        }
+    }
+
+public:
+    FixedSizePool(const FixedSizePool&) = delete;
+    FixedSizePool& operator=(const FixedSizePool&) = delete;
+
+    static FixedSizePool& Instance() {
+        static FixedSizePool* pool = new FixedSizePool();
+        return *pool;
+    }
+
+    void* Allocate() {
+        if (CacheDestroyed()) [[unlikely]] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (head_ == nullptr) {
+                Carve();
+            }
+            return std::exchange(head_, head_->next);
+        }
+        ThreadCache& cache = LocalCache();
+        if (cache.head == nullptr) {
+            Refill(cache);
+        }
+        FreeBlock* block = cache.head;
+        cache.head = block->next;
+        --cache.size;
+        return block;
+    }
+
+    void Deallocate(void* ptr) {
+        auto block = static_cast<FreeBlock*>(ptr);
+        if (CacheDestroyed()) [[unlikely]] {
+            block->next = nullptr;
+            PushBatch(block, 1);
+            return;
+        }
+        ThreadCache& cache = LocalCache();
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.size == 2 * kBatchSize) {
+            // Hand the older half back so one thread freeing what another allocated does not
+            // hoard the whole pool.
+            FreeBlock* rest = cache.head;
+            for (std::size_t i = 1; i < kBatchSize; ++i) {
+                rest = rest->next;
+            }
+            PushBatch(rest->next, kBatchSize);
+            rest->next = nullptr;
+            cache.size = kBatchSize;
+        }
+    }
+};
+
+// Standard allocator on top of `FixedSizePool`. Single-object requests (control blocks, list
+// nodes) come from the pool for `sizeof(T)`, anything else falls through to `operator new`.
+template <typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+
+    PoolAllocator() = default;
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) {
+    }
+
+    T* allocate(std::size_t n) {
+        if (n == 1) {
+            return static_cast<T*>(FixedSizePool<sizeof(T), alignof(T)>::Instance().Allocate());
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(alignof(T))));
+    }
+
+    void deallocate(T* ptr, std::size_t n) {
+        if (n == 1) {
+            FixedSizePool<sizeof(T), alignof(T)>::Instance().Deallocate(ptr);
+        } else {
+            ::operator delete(ptr, std::align_val_t(alignof(T)));
+        }
+    }
+};
+
+template <typename T, typename U>
+inline bool operator==(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return true;
+}
+
+template <typename T, typename U>
+inline bool operator!=(const PoolAllocator<T>&, const PoolAllocator<U>&) {
+    return false;
+}
@@ -2,15 +2,22 @@
 
 #include "sw_fwd.h" // forward declaration
 
+#include <arena.h>
+#include <instrumentation.h>
+
 #include <algorithm>
 #include <any>
+#include <atomic>
 #include <utility>
 #include <cstddef>
 #include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
 #include <type_traits>
 
 struct SharedPtrObject {
-    size_t use_count_;
+    std::atomic<size_t> use_count_;
     bool allocated_with_make_share_;
 
     SharedPtrObject(size_t use_count, bool allocated_with_make_share = false)
@@ -18,9 +25,14 @@ struct SharedPtrObject {
     }
 
     virtual ~SharedPtrObject() = 0;
+
+    // Destroys the control block together with the object and frees the memory it came from.
+    virtual void Destroy() {
+        delete this;
+    }
 };
 
-SharedPtrObject::~SharedPtrObject() {
+inline SharedPtrObject::~SharedPtrObject() {
 }
 
 template <typename T>
@@ -38,6 +50,68 @@ struct SharedPtrObjectWithType : public SharedPtrObject {
             delete ptr_;
         }
     }
+
+    void Destroy() override {
+        if (allocated_with_make_share_) {
+            // `MakeShared` places the block at the start of a `new char[]` buffer
+            char* buf = reinterpret_cast<char*>(this);
+            this->~SharedPtrObjectWithType();
+            delete[] buf;
+        } else {
+            delete this;
+        }
+    }
+};
+
+// Control block for a pointer adopted with a user allocator: the block itself lives in memory
+// obtained from `Alloc`, the object is still released with `delete`.
+template <typename T, typename Alloc>
+struct SharedPtrObjectWithAllocator : public SharedPtrObjectWithType<T> {
+    using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<
+        SharedPtrObjectWithAllocator>;
+
+    [[no_unique_address]] Alloc alloc_;
+
+    SharedPtrObjectWithAllocator(T* ptr, const Alloc& alloc)
+        : SharedPtrObjectWithType<T>(ptr), alloc_(alloc) {
+    }
+
+    void Destroy() override {
+        BlockAlloc alloc(alloc_);
+        this->~SharedPtrObjectWithAllocator();
+        std::allocator_traits<BlockAlloc>::deallocate(alloc, this, 1);
+    }
+};
+
+// Control block of `AllocateShared`: the object is stored inside the block, so both come from
+// one allocation of `Alloc`.
+template <typename T, typename Alloc>
+struct SharedPtrObjectInplace : public SharedPtrObject {
+    using BlockAlloc =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<SharedPtrObjectInplace>;
+
+    [[no_unique_address]] Alloc alloc_;
+    alignas(T) char storage_[sizeof(T)];
+
+    template <typename... Args>
+    SharedPtrObjectInplace(const Alloc& alloc, Args&&... args)
+        : SharedPtrObject(1, true), alloc_(alloc) {
+        new (storage_) T(std::forward<Args>(args)...);
+    }
+
+    ~SharedPtrObjectInplace() {
+        GetObject()->~T();
+    }
+
+    T* GetObject() {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    void Destroy() override {
+        BlockAlloc alloc(alloc_);
+        this->~SharedPtrObjectInplace();
+        std::allocator_traits<BlockAlloc>::deallocate(alloc, this, 1);
+    }
 };
 
 template <typename T>
@@ -45,11 +119,22 @@ class SharedPtr {
 private:
     SharedPtrObject* managed_ptr_;
     T* ptr_;
-    char* buf_ = nullptr;
 
     template <typename Y>
     friend class SharedPtr;
 
+    template <typename Y>
+    friend class AtomicSharedPtr;
+
+    template <typename U, typename Alloc, typename... Args>
+    friend SharedPtr<U> AllocateShared(const Alloc& alloc, Args&&... args);
+
+    SharedPtr(SharedPtrObject* managed_ptr, T* ptr) : managed_ptr_(managed_ptr), ptr_(ptr) {
+    }
+
+    template <typename Y, typename Alloc>
+    static SharedPtrObject* NewBlockWithAllocator(Y* ptr, const Alloc& alloc);
+
     void Unshare();
     void IncrementUseCount();
 
@@ -61,6 +146,15 @@ public:
     SharedPtr(std::nullptr_t);
     template <typename Y>
     explicit SharedPtr(Y* ptr) : managed_ptr_(new SharedPtrObjectWithType<Y>(ptr)), ptr_(ptr) {
+        INSTRUMENT_ALLOCATION(SHARED_PTR_BLOCK, sizeof(SharedPtrObjectWithType<Y>));
+    }
+
+    // Same as `SharedPtr(ptr)`, but the control block is allocated with `alloc`. If that
+    // throws, `ptr` is deleted before the exception propagates.
+    template <typename Y, typename Alloc>
+        requires(!std::is_pointer_v<Alloc>)
+    SharedPtr(Y* ptr, const Alloc& alloc)
+        : managed_ptr_(NewBlockWithAllocator(ptr, alloc)), ptr_(ptr) {
     }
 
     SharedPtr(const SharedPtr& other);
@@ -72,22 +166,18 @@ public:
     }
 
     SharedPtr(T* ptr, char* block_location)
-        : managed_ptr_(new (block_location) SharedPtrObjectWithType<T>(ptr, true)),
-          ptr_(ptr),
-          buf_(block_location) {
+        : managed_ptr_(new (block_location) SharedPtrObjectWithType<T>(ptr, true)), ptr_(ptr) {
     }
 
     template <typename Y>
-    SharedPtr(SharedPtr<Y>&& other)
-        : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_), buf_(other.buf_) {
+    SharedPtr(SharedPtr<Y>&& other) : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_) {
         IncrementUseCount();
         other.Unshare();
         other.ptr_ = nullptr;
     }
 
     template <typename Y>
-    SharedPtr(const SharedPtr<Y>& other, T* ptr)
-        : managed_ptr_(other.managed_ptr_), ptr_(ptr), buf_(other.buf_) {
+    SharedPtr(const SharedPtr<Y>& other, T* ptr) : managed_ptr_(other.managed_ptr_), ptr_(ptr) {
         IncrementUseCount();
     }
 
@@ -111,6 +201,16 @@ public:
     void Reset(Y* ptr) {
         Unshare();
         managed_ptr_ = new SharedPtrObjectWithType<Y>(ptr);
+        INSTRUMENT_ALLOCATION(SHARED_PTR_BLOCK, sizeof(SharedPtrObjectWithType<Y>));
+        ptr_ = ptr;
+    }
+
+    // If the block cannot be allocated, `ptr` is deleted and `*this` is left as it was
+    template <typename Y, typename Alloc>
+    void Reset(Y* ptr, const Alloc& alloc) {
+        SharedPtrObject* block = NewBlockWithAllocator(ptr, alloc);
+        Unshare();
+        managed_ptr_ = block;
         ptr_ = ptr;
     }
 
@@ -131,27 +231,67 @@ inline bool operator==(const SharedPtr<T>& left, const SharedPtr<U>& right) {
     return left.Get() == right.Get();
 }
 
+// The block and the object come from the global heap, also inside an `ArenaScope`, so the
+// pointer may outlive any arena; `MakeArenaShared` is the arena counterpart
 template <typename T, typename... Args>
 SharedPtr<T> MakeShared(Args&&... args) {
     char* buf = new char[sizeof(SharedPtrObjectWithType<T>) + sizeof(T)];
+    INSTRUMENT_ALLOCATION(MAKE_SHARED, sizeof(SharedPtrObjectWithType<T>) + sizeof(T));
     auto block_location = buf;
     auto element_location = buf + sizeof(SharedPtrObjectWithType<T>);
     T* ptr = new (element_location) T(std::forward<Args>(args)...);
     return SharedPtr<T>(ptr, block_location);
 }
 
+// Like `MakeShared`, but the control block and the object share one allocation from `alloc`
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateShared(const Alloc& alloc, Args&&... args) {
+    using Block = SharedPtrObjectInplace<T, Alloc>;
+    typename Block::BlockAlloc block_alloc(alloc);
+    Block* block = std::allocator_traits<typename Block::BlockAlloc>::allocate(block_alloc, 1);
+    INSTRUMENT_ALLOCATION(ALLOCATE_SHARED, sizeof(Block));
+    try {
+        new (block) Block(alloc, std::forward<Args>(args)...);
+    } catch (...) {
+        std::allocator_traits<typename Block::BlockAlloc>::deallocate(block_alloc, block, 1);
+        throw;
+    }
+    return SharedPtr<T>(block, block->GetObject());
+}
+
+// Block and object in the arena of the active `ArenaScope`. The arena does not track them:
+// this pointer and every copy of it must be gone before the arena is released
+template <typename T, typename... Args>
+SharedPtr<T> MakeArenaShared(Args&&... args) {
+    MonotonicArena* arena = MonotonicArena::Current();
+    if (arena == nullptr) {
+        throw std::logic_error("MakeArenaShared: no active ArenaScope");
+    }
+    return AllocateShared<T>(ArenaAllocator<T>(*arena), std::forward<Args>(args)...);
+}
+
+template <typename T>
+template <typename Y, typename Alloc>
+SharedPtrObject* SharedPtr<T>::NewBlockWithAllocator(Y* ptr, const Alloc& alloc) {
+    using Block = SharedPtrObjectWithAllocator<Y, Alloc>;
+    typename Block::BlockAlloc block_alloc(alloc);
+    Block* block;
+    try {
+        block = std::allocator_traits<typename Block::BlockAlloc>::allocate(block_alloc, 1);
+    } catch (...) {
+        delete ptr;
+        throw;
+    }
+    INSTRUMENT_ALLOCATION(SHARED_PTR_BLOCK, sizeof(Block));
+    return new (block) Block(ptr, alloc);
+}
+
 template <typename T>
 void SharedPtr<T>::Unshare() {
     if (managed_ptr_) {
-        --managed_ptr_->use_count_;
-        if (managed_ptr_->use_count_ == 0) {
-            if (buf_) {
-                managed_ptr_->~SharedPtrObject();
-                delete[] buf_;
-                buf_ = nullptr;
-            } else {
-                delete managed_ptr_;
-            }
+        INSTRUMENT_REF_COUNT(SHARED_PTR_REFS);
+        if (managed_ptr_->use_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            managed_ptr_->Destroy();
         }
         managed_ptr_ = nullptr;
     }
@@ -160,7 +300,8 @@ void SharedPtr<T>::Unshare() {
 template <typename T>
 void SharedPtr<T>::IncrementUseCount() {
     if (managed_ptr_) {
-        ++managed_ptr_->use_count_;
+        INSTRUMENT_REF_COUNT(SHARED_PTR_REFS);
+        managed_ptr_->use_count_.fetch_add(1, std::memory_order_relaxed);
     }
 }
 
@@ -173,14 +314,12 @@ SharedPtr<T>::SharedPtr(std::nullptr_t) : managed_ptr_(nullptr), ptr_(nullptr) {
 }
 
 template <typename T>
-SharedPtr<T>::SharedPtr(const SharedPtr& other)
-    : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_), buf_(other.buf_) {
+SharedPtr<T>::SharedPtr(const SharedPtr& other) : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_) {
     IncrementUseCount();
 }
 
 template <typename T>
-SharedPtr<T>::SharedPtr(SharedPtr&& other)
-    : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_), buf_(other.buf_) {
+SharedPtr<T>::SharedPtr(SharedPtr&& other) : managed_ptr_(other.managed_ptr_), ptr_(other.ptr_) {
     IncrementUseCount();
     other.Unshare();
     other.ptr_ = nullptr;
@@ -193,7 +332,6 @@ SharedPtr<T>& SharedPtr<T>::operator=(const SharedPtr& other) {
         managed_ptr_ = other.managed_ptr_;
         IncrementUseCount();
     }
-    buf_ = other.buf_;
     ptr_ = other.ptr_;
     return *this;
 }
@@ -203,7 +341,6 @@ SharedPtr<T>& SharedPtr<T>::operator=(SharedPtr&& other) {
     if (managed_ptr_ != other.managed_ptr_) {
         Unshare();
         managed_ptr_ = other.managed_ptr_;
-        buf_ = other.buf_;
         IncrementUseCount();
         other.Unshare();
     }
@@ -247,7 +384,7 @@ T* SharedPtr<T>::operator->() const {
 template <typename T>
 size_t SharedPtr<T>::UseCount() const {
     if (managed_ptr_) {
-        return managed_ptr_->use_count_;
+        return managed_ptr_->use_count_.load(std::memory_order_relaxed);
     }
     return 0;
 }
@@ -3,4 +3,10 @@
 #include <exception>
 
 template <typename T>
-class SharedPtr;
\ No newline at end of file
+class SharedPtr;
+
+template <typename T>
+class AtomicSharedPtr;
+
+template <typename T, typename Alloc, typename... Args>
+SharedPtr<T> AllocateShared(const Alloc& alloc, Args&&... args);
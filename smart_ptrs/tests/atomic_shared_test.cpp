@@ -0,0 +1,102 @@
+#include <atomic_shared.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Stays consistent as long as nobody reads it after destruction
+struct Snapshot {
+    static inline std::atomic<int> alive = 0;
+
+    int64_t version;
+    int64_t check;
+
+    explicit Snapshot(int64_t version) : version(version), check(-version) {
+        ++alive;
+    }
+
+    ~Snapshot() {
+        check = 0;
+        --alive;
+    }
+};
+
+}  // namespace
+
+TEST(AtomicSharedPtr, LoadStoreExchange) {
+    {
+        AtomicSharedPtr<Snapshot> atomic(MakeShared<Snapshot>(1));
+        SharedPtr<Snapshot> loaded = atomic.Load();
+        EXPECT_EQ(loaded->version, 1);
+        EXPECT_EQ(loaded.UseCount(), 2u);
+        atomic.Store(MakeShared<Snapshot>(2));
+        EXPECT_EQ(loaded.UseCount(), 1u);
+        SharedPtr<Snapshot> previous = atomic.Exchange(nullptr);
+        EXPECT_EQ(previous->version, 2);
+        EXPECT_FALSE(atomic.Load());
+    }
+    EXPECT_EQ(Snapshot::alive.load(), 0);
+}
+
+TEST(AtomicSharedPtr, CompareExchange) {
+    SharedPtr<Snapshot> first = MakeShared<Snapshot>(1);
+    AtomicSharedPtr<Snapshot> atomic(first);
+    SharedPtr<Snapshot> expected = MakeShared<Snapshot>(99);
+    EXPECT_FALSE(atomic.CompareExchange(expected, MakeShared<Snapshot>(2)));
+    EXPECT_EQ(expected, first);
+    EXPECT_TRUE(atomic.CompareExchange(expected, MakeShared<Snapshot>(3)));
+    EXPECT_EQ(atomic.Load()->version, 3);
+}
+
+// Readers copy the pointer while writers keep replacing it; every snapshot a reader sees must
+// still be alive and intact
+TEST(AtomicSharedPtr, ReadersNeverSeeFreedSnapshots) {
+    constexpr int kReaders = 4;
+    constexpr int kWriters = 2;
+    constexpr int64_t kWrites = 20000;
+    {
+        AtomicSharedPtr<Snapshot> atomic(MakeShared<Snapshot>(0));
+        std::atomic<int64_t> next_version = 1;
+        std::atomic<bool> done = false;
+        std::atomic<int> errors = 0;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < kReaders; ++i) {
+            threads.emplace_back([&] {
+                while (!done.load(std::memory_order_relaxed)) {
+                    SharedPtr<Snapshot> snapshot = atomic.Load();
+                    if (snapshot->check != -snapshot->version) {
+                        ++errors;
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < kWriters; ++i) {
+            threads.emplace_back([&] {
+                for (int64_t w = 0; w < kWrites; ++w) {
+                    int64_t version = next_version.fetch_add(1);
+                    if (w % 2 == 0) {
+                        atomic.Store(MakeShared<Snapshot>(version));
+                    } else {
+                        SharedPtr<Snapshot> expected = atomic.Load();
+                        while (!atomic.CompareExchange(expected, MakeShared<Snapshot>(version))) {
+                        }
+                    }
+                }
+            });
+        }
+        for (int i = kReaders; i < kReaders + kWriters; ++i) {
+            threads[i].join();
+        }
+        done = true;
+        for (int i = 0; i < kReaders; ++i) {
+            threads[i].join();
+        }
+        EXPECT_EQ(errors.load(), 0);
+        EXPECT_EQ(Snapshot::alive.load(), 1);
+    }
+    EXPECT_EQ(Snapshot::alive.load(), 0);
+}
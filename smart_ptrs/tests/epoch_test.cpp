@@ -0,0 +1,187 @@
+#include <epoch.h>
+#include <unique.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Tracked {
+    static inline std::atomic<int> alive = 0;
+
+    int64_t value;
+    Tracked* next = nullptr;
+
+    explicit Tracked(int64_t value = 0) : value(value) {
+        ++alive;
+    }
+
+    ~Tracked() {
+        value = -1;
+        --alive;
+    }
+};
+
+using RetiredPtr = UniquePtr<Tracked, RetireDeleter<Tracked>>;
+
+// Constructed before the domain, so its destructor runs after the domain's would
+struct RetiresAtExit {
+    ~RetiresAtExit() {
+        EpochGuard guard;
+        RetiredPtr node(new Tracked(1));
+        node.Reset();
+        EpochDomain::Instance().Collect();
+        std::fputs("retired at exit\n", stderr);
+    }
+};
+
+void CollectAll() {
+    for (int i = 0; i < 8; ++i) {
+        EpochDomain::Instance().Collect();
+    }
+}
+
+// Treiber stack: popped nodes are retired, so a concurrent `Pop` that still holds the old head
+// can read its `next` safely and the address cannot come back while it does (no ABA)
+class Stack {
+public:
+    ~Stack() {
+        while (Tracked* node = head_.load()) {
+            head_.store(node->next);
+            delete node;
+        }
+    }
+
+    void Push(int64_t value) {
+        auto* node = new Tracked(value);
+        node->next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    bool Pop(int64_t* value) {
+        EpochGuard guard;
+        Tracked* node = head_.load(std::memory_order_acquire);
+        while (node != nullptr && !head_.compare_exchange_weak(node, node->next,
+                                                               std::memory_order_acquire,
+                                                               std::memory_order_acquire)) {
+        }
+        if (node == nullptr) {
+            return false;
+        }
+        *value = node->value;
+        RetiredPtr retired(node);
+        return true;
+    }
+
+private:
+    std::atomic<Tracked*> head_ = nullptr;
+};
+
+}  // namespace
+
+TEST(EpochDomain, GuardOfTheRetiringThreadDelaysReclamation) {
+    CollectAll();
+    int before = Tracked::alive.load();
+    {
+        EpochGuard guard;
+        RetiredPtr pointer(new Tracked());
+        pointer.Reset();
+        CollectAll();
+        EXPECT_EQ(Tracked::alive.load(), before + 1);
+    }
+    CollectAll();
+    EXPECT_EQ(Tracked::alive.load(), before);
+}
+
+TEST(EpochDomain, ReaderInAnotherThreadDelaysReclamation) {
+    CollectAll();
+    int before = Tracked::alive.load();
+    std::atomic<bool> entered = false;
+    std::atomic<bool> leave = false;
+    std::thread reader([&] {
+        EpochGuard guard;
+        entered = true;
+        while (!leave) {
+            std::this_thread::yield();
+        }
+    });
+    while (!entered) {
+        std::this_thread::yield();
+    }
+    RetiredPtr pointer(new Tracked());
+    pointer.Reset();
+    CollectAll();
+    EXPECT_EQ(Tracked::alive.load(), before + 1);
+    leave = true;
+    reader.join();
+    CollectAll();
+    EXPECT_EQ(Tracked::alive.load(), before);
+}
+
+TEST(EpochDomain, ReclaimsInBatches) {
+    CollectAll();
+    int before = Tracked::alive.load();
+    for (size_t i = 0; i < 10 * EpochDomain::kBatchSize; ++i) {
+        RetiredPtr pointer(new Tracked());
+    }
+    // Retiring triggers collection every kBatchSize nodes, so only the last batches wait
+    EXPECT_LE(Tracked::alive.load(), before + 3 * static_cast<int>(EpochDomain::kBatchSize));
+    CollectAll();
+    EXPECT_EQ(Tracked::alive.load(), before);
+}
+
+TEST(EpochDomain, LockFreeStackUnderContention) {
+    constexpr int kThreads = 4;
+    constexpr int64_t kPerThread = 20000;
+    Stack stack;
+    std::atomic<int64_t> popped_sum = 0;
+    std::atomic<int64_t> popped_count = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            int64_t sum = 0;
+            int64_t count = 0;
+            for (int64_t i = 0; i < kPerThread; ++i) {
+                stack.Push(t * kPerThread + i);
+                int64_t value;
+                if (stack.Pop(&value)) {
+                    EXPECT_GE(value, 0);
+                    sum += value;
+                    ++count;
+                }
+            }
+            popped_sum += sum;
+            popped_count += count;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    int64_t value;
+    while (stack.Pop(&value)) {
+        popped_sum += value;
+        ++popped_count;
+    }
+    int64_t total = kThreads * kPerThread;
+    EXPECT_EQ(popped_count.load(), total);
+    EXPECT_EQ(popped_sum.load(), total * (total - 1) / 2);
+}
+
+// Runs in a fresh process, where the domain does not exist before the static below
+TEST(EpochDomainDeathTest, UsableFromStaticDestructors) {
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            static RetiresAtExit retires;
+            { EpochGuard guard; }
+            std::exit(0);
+        },
+        testing::ExitedWithCode(0), "retired at exit");
+}
@@ -0,0 +1,122 @@
+#include <intrusive.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct LocalNode : RefCounted<LocalNode, SimpleRefCount> {
+    static inline int alive = 0;
+
+    int value;
+
+    explicit LocalNode(int value = 0) : value(value) {
+        ++alive;
+    }
+
+    LocalNode(const LocalNode& other) : RefCounted(other), value(other.value) {
+        ++alive;
+    }
+
+    ~LocalNode() {
+        --alive;
+    }
+};
+
+struct SharedNode : RefCounted<SharedNode> {
+    int value = 0;
+};
+
+// Counted elsewhere, found through ADL
+struct External {
+    int references = 0;
+    bool released = false;
+};
+
+void IntrusivePtrAddRef(const External* ptr) {
+    ++const_cast<External*>(ptr)->references;
+}
+
+void IntrusivePtrRelease(const External* ptr) {
+    auto* external = const_cast<External*>(ptr);
+    if (--external->references == 0) {
+        external->released = true;
+    }
+}
+
+}  // namespace
+
+TEST(SimpleRefCount, DestroysWithTheLastReference) {
+    {
+        IntrusivePtr<LocalNode> first = MakeIntrusive<LocalNode>(1);
+        EXPECT_EQ(first.UseCount(), 1u);
+        IntrusivePtr<LocalNode> second = first;
+        IntrusivePtr<LocalNode> third;
+        third = second;
+        EXPECT_EQ(first.UseCount(), 3u);
+        second.Reset();
+        third = std::move(first);
+        EXPECT_FALSE(first);
+        EXPECT_EQ(third.UseCount(), 1u);
+        EXPECT_EQ(LocalNode::alive, 1);
+    }
+    EXPECT_EQ(LocalNode::alive, 0);
+}
+
+TEST(SimpleRefCount, CopiedObjectStartsWithItsOwnCount) {
+    IntrusivePtr<LocalNode> original = MakeIntrusive<LocalNode>(5);
+    IntrusivePtr<LocalNode> extra = original;
+    IntrusivePtr<LocalNode> copy = MakeIntrusive<LocalNode>(*original);
+    EXPECT_EQ(copy.UseCount(), 1u);
+    EXPECT_EQ(original.UseCount(), 2u);
+    EXPECT_EQ(copy->value, 5);
+}
+
+TEST(SimpleRefCount, DetachAndAdopt) {
+    IntrusivePtr<LocalNode> pointer = MakeIntrusive<LocalNode>(2);
+    LocalNode* raw = pointer.Detach();
+    EXPECT_FALSE(pointer);
+    EXPECT_EQ(LocalNode::alive, 1);
+    IntrusivePtr<LocalNode> adopted(raw, false);
+    EXPECT_EQ(adopted.UseCount(), 1u);
+    adopted.Reset();
+    EXPECT_EQ(LocalNode::alive, 0);
+}
+
+TEST(SimpleRefCount, TakesOverAUniquePtr) {
+    UniquePtr<LocalNode> unique(new LocalNode(3));
+    IntrusivePtr<LocalNode> shared(std::move(unique));
+    EXPECT_FALSE(unique);
+    EXPECT_EQ(shared.UseCount(), 1u);
+    EXPECT_EQ(shared->value, 3);
+}
+
+TEST(IntrusivePtr, UsesAdlHooks) {
+    External external;
+    {
+        IntrusivePtr<External> first(&external);
+        IntrusivePtr<External> second = first;
+        EXPECT_EQ(external.references, 2);
+    }
+    EXPECT_EQ(external.references, 0);
+    EXPECT_TRUE(external.released);
+}
+
+TEST(IntrusivePtr, AtomicCountSurvivesThreads) {
+    IntrusivePtr<SharedNode> node = MakeIntrusive<SharedNode>();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&node] {
+            for (int i = 0; i < 10000; ++i) {
+                IntrusivePtr<SharedNode> copy = node;
+                EXPECT_GE(copy.UseCount(), 2u);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(node.UseCount(), 1u);
+}
@@ -0,0 +1,87 @@
+#include <object_pool.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+struct Resettable {
+    static inline int constructions = 0;
+    static inline int destructions = 0;
+    static inline int resets = 0;
+
+    int value;
+
+    explicit Resettable(int value = 0) : value(value) {
+        ++constructions;
+    }
+
+    ~Resettable() {
+        ++destructions;
+    }
+
+    void ResetForReuse() {
+        value = 0;
+        ++resets;
+    }
+};
+
+// Reports its destruction, so a death test can see it happen during exit
+struct ReportsDestruction {
+    void ResetForReuse() {
+    }
+
+    ~ReportsDestruction() {
+        std::fputs("destroyed at exit\n", stderr);
+    }
+};
+
+}  // namespace
+
+TEST(ObjectPool, ResettableObjectsStayConstructed) {
+    Resettable::constructions = Resettable::destructions = Resettable::resets = 0;
+    Resettable* address;
+    {
+        PooledPtr<Resettable> pointer = MakePooled<Resettable>(7);
+        address = pointer.Get();
+    }
+    EXPECT_EQ(Resettable::resets, 1);
+    EXPECT_EQ(Resettable::destructions, 0);
+
+    // Without arguments the reset object is handed out as is
+    PooledPtr<Resettable> again = MakePooled<Resettable>();
+    EXPECT_EQ(again.Get(), address);
+    EXPECT_EQ(again->value, 0);
+    EXPECT_EQ(Resettable::constructions, 1);
+    again.Reset();
+
+    // With arguments it is rebuilt in the same slot
+    PooledPtr<Resettable> rebuilt = MakePooled<Resettable>(9);
+    EXPECT_EQ(rebuilt.Get(), address);
+    EXPECT_EQ(rebuilt->value, 9);
+    EXPECT_EQ(Resettable::constructions, 2);
+    EXPECT_EQ(Resettable::destructions, 1);
+}
+
+TEST(ObjectPool, CacheIsBounded) {
+    std::vector<PooledPtr<Resettable>> pointers;
+    for (size_t i = 0; i < ObjectPool<Resettable>::kMaxCachedPerThread + 10; ++i) {
+        pointers.push_back(MakePooled<Resettable>());
+    }
+    pointers.clear();
+    EXPECT_EQ(ObjectPool<Resettable>::CachedCount(), ObjectPool<Resettable>::kMaxCachedPerThread);
+}
+
+// Thread-local objects are destroyed before static ones, so a static `PooledPtr` is recycled
+// after the cache is gone and has to be freed instead
+TEST(ObjectPoolDeathTest, StaticPointerReleasedAfterTheCache) {
+    EXPECT_EXIT(
+        {
+            static PooledPtr<ReportsDestruction> kept = MakePooled<ReportsDestruction>();
+            std::exit(0);
+        },
+        testing::ExitedWithCode(0), "destroyed at exit");
+}
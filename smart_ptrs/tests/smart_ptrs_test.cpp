@@ -0,0 +1,156 @@
+#include <arena.h>
+#include <intrusive.h>
+#include <object_pool.h>
+#include <pool_allocator.h>
+#include <shared.h>
+#include <unique.h>
+
+#include <gtest/gtest.h>
+
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Counted {
+    static inline int alive = 0;
+
+    int value;
+
+    explicit Counted(int value = 0) : value(value) {
+        ++alive;
+    }
+
+    ~Counted() {
+        --alive;
+    }
+};
+
+struct Node : RefCounted<Node> {
+    int value = 0;
+};
+
+// Allocator whose every allocation fails
+template <class T>
+struct ExhaustedAllocator {
+    using value_type = T;
+
+    ExhaustedAllocator() = default;
+
+    template <class U>
+    ExhaustedAllocator(const ExhaustedAllocator<U>&) {
+    }
+
+    T* allocate(size_t) {
+        throw std::bad_alloc();
+    }
+
+    void deallocate(T*, size_t) {
+    }
+
+    template <class U>
+    bool operator==(const ExhaustedAllocator<U>&) const {
+        return true;
+    }
+};
+
+}  // namespace
+
+TEST(SharedPtr, CountsOwners) {
+    {
+        SharedPtr<Counted> first = MakeShared<Counted>(5);
+        EXPECT_EQ(first.UseCount(), 1u);
+        SharedPtr<Counted> second = first;
+        SharedPtr<Counted> third(new Counted(6));
+        EXPECT_EQ(first.UseCount(), 2u);
+        third = std::move(second);
+        EXPECT_EQ(first.UseCount(), 2u);
+        EXPECT_EQ(third->value, 5);
+        EXPECT_EQ(Counted::alive, 1);
+        first.Reset();
+        EXPECT_EQ(third.UseCount(), 1u);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(SharedPtr, AllocateSharedUsesTheAllocator) {
+    {
+        SharedPtr<Counted> pointer = AllocateShared<Counted>(PoolAllocator<Counted>(), 9);
+        EXPECT_EQ(pointer->value, 9);
+    }
+    EXPECT_EQ(Counted::alive, 0);
+}
+
+TEST(SharedPtr, FailedBlockAllocationDeletesThePointer) {
+    EXPECT_THROW(SharedPtr<Counted>(new Counted(1), ExhaustedAllocator<Counted>()),
+                 std::bad_alloc);
+    EXPECT_EQ(Counted::alive, 0);
+
+    SharedPtr<Counted> pointer = MakeShared<Counted>(2);
+    EXPECT_THROW(pointer.Reset(new Counted(3), ExhaustedAllocator<Counted>()), std::bad_alloc);
+    EXPECT_EQ(Counted::alive, 1);
+    EXPECT_EQ(pointer->value, 2);
+    EXPECT_EQ(pointer.UseCount(), 1u);
+}
+
+// Only `MakeArenaShared` uses the scope's arena; a `MakeShared` pointer outlives both
+TEST(SharedPtr, MakeSharedIgnoresTheArenaScope) {
+    SharedPtr<Counted> survivor;
+    {
+        MonotonicArena arena;
+        ArenaScope scope(arena);
+        survivor = MakeShared<Counted>(4);
+        SharedPtr<Counted> in_arena = MakeArenaShared<Counted>(5);
+        EXPECT_EQ(in_arena->value, 5);
+        EXPECT_EQ(Counted::alive, 2);
+    }
+    EXPECT_EQ(survivor->value, 4);
+    EXPECT_EQ(Counted::alive, 1);
+    survivor.Reset();
+    EXPECT_EQ(Counted::alive, 0);
+    EXPECT_THROW(MakeArenaShared<Counted>(6), std::logic_error);
+}
+
+TEST(UniquePtr, OwnsAndReleases) {
+    UniquePtr<Counted> pointer(new Counted(1));
+    UniquePtr<Counted> other = std::move(pointer);
+    EXPECT_FALSE(pointer);
+    EXPECT_EQ(other->value, 1);
+    Counted* raw = other.Release();
+    EXPECT_EQ(Counted::alive, 1);
+    other.Reset(raw);
+    other.Reset();
+    EXPECT_EQ(Counted::alive, 0);
+
+    UniquePtr<int[]> array(new int[3]{1, 2, 3});
+    EXPECT_EQ(array[2], 3);
+}
+
+TEST(IntrusivePtr, SharesTheEmbeddedCount) {
+    IntrusivePtr<Node> first = MakeIntrusive<Node>();
+    IntrusivePtr<Node> second = first;
+    EXPECT_EQ(first.UseCount(), 2u);
+    second.Reset();
+    EXPECT_EQ(first.UseCount(), 1u);
+}
+
+TEST(ObjectPool, ReusesSlots) {
+    Counted* address;
+    {
+        PooledPtr<Counted> pointer = MakePooled<Counted>(3);
+        address = pointer.Get();
+    }
+    PooledPtr<Counted> again = MakePooled<Counted>(4);
+    EXPECT_EQ(again.Get(), address);
+    EXPECT_EQ(again->value, 4);
+}
+
+TEST(PoolAllocator, BacksContainers) {
+    std::vector<int, PoolAllocator<int>> values;
+    for (int i = 0; i < 1000; ++i) {
+        values.push_back(i);
+    }
+    EXPECT_EQ(values[500], 500);
+}
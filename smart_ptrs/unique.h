@@ -2,9 +2,12 @@
 
 #include "compressed_pair.h"
 
+#include <arena.h>
+
 #include <algorithm>
 #include <memory>
 #include <cstddef>
+#include <stdexcept>
 #include <type_traits>
 
 template <typename T>
@@ -324,4 +327,20 @@ std::add_lvalue_reference_t<T> UniquePtr<T[], Deleter>::operator[](size_t i) con
 template <typename T, typename Deleter>
 T* UniquePtr<T[], Deleter>::operator->() const {
     return data_.GetFirst();
-}
\ No newline at end of file
+}
+
+template <typename T>
+using ArenaPtr = UniquePtr<T, ArenaDeleter<T>>;
+
+// Constructs `T` in the arena of the active `ArenaScope`; the memory goes away with the arena
+template <typename T, typename... Args>
+ArenaPtr<T> MakeArenaUnique(Args&&... args) {
+    MonotonicArena* arena = MonotonicArena::Current();
+    if (arena == nullptr) {
+        throw std::logic_error("MakeArenaUnique: no active ArenaScope");
+    }
+    void* memory = arena->Allocate(sizeof(T), alignof(T));
+    return ArenaPtr<T>(new (memory) T(std::forward<Args>(args)...));
+}
+
+static_assert(sizeof(ArenaPtr<int>) == sizeof(int*));